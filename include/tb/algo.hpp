@@ -1,13 +1,64 @@
 #pragma once
 
+#include "tb/arena.hpp"
 #include "tb/data.hpp"
+#include "tb/stats.hpp"
 
 namespace tb {
 
+// Selects which of several equal hashes inside a window becomes the minimizer
+enum class TiePolicy : std::uint8_t {
+  kLeftmost,
+  kRightmost,
+  // Robust winnowing: rightmost, but the previous minimizer is kept for as long
+  // as it stays in the window and ties with the window minimum
+  kRobust,
+};
+
 struct MinimizeArgs {
   MockSequence const& seq;
   std::int32_t window_length;
   std::int32_t kmer_length;
+  TiePolicy tie_policy = TiePolicy::kLeftmost;
+  // optional heap usage report for the call
+  MemoryStats* stats = nullptr;
+  // optional backing for hash and scratch buffers, reused across calls
+  Arena* arena = nullptr;
+};
+
+// Window lengths must ascend (std::invalid_argument otherwise); each level is
+// a subset of the one before
+struct MinimizeLevelsArgs {
+  MockSequence const& seq;
+  std::span<std::int32_t const> window_lengths;
+  std::int32_t kmer_length;
+  TiePolicy tie_policy = TiePolicy::kLeftmost;
+  MemoryStats* stats = nullptr;
+  Arena* arena = nullptr;
+};
+
+struct MinimizeRecordsArgs {
+  MockSequenceSet const& records;
+  std::int32_t window_length;
+  std::int32_t kmer_length;
+  TiePolicy tie_policy = TiePolicy::kLeftmost;
+  // optional heap usage report for the call
+  MemoryStats* stats = nullptr;
+  // optional backing for hash and scratch buffers, reused across calls
+  Arena* arena = nullptr;
+};
+
+// Minimizer space projection: every run of `kminmer_length` consecutive
+// minimizers becomes one k-min-mer. The length must be positive
+// (std::invalid_argument otherwise)
+struct MinimizeKMinMersArgs {
+  MockSequence const& seq;
+  std::int32_t window_length;
+  std::int32_t kmer_length;
+  std::int32_t kminmer_length;
+  TiePolicy tie_policy = TiePolicy::kLeftmost;
+  MemoryStats* stats = nullptr;
+  Arena* arena = nullptr;
 };
 
 std::vector<KMer::value_type> NtHash(MinimizeArgs);
@@ -32,4 +83,28 @@ std::vector<KMer> NtHashRecoveryUnrolledMinimize(MinimizeArgs);
 // Split window
 std::vector<KMer> SplitWindowMinimize(MinimizeArgs);
 
+// Cache blocked NtHash with fused sampling
+std::vector<KMer> NtHashBlockedRecoveryMinimize(MinimizeArgs);
+
+// Multi record implementations; minimizers never span record boundaries
+std::vector<RecordKMer> ArgMinRecoveryUnrolledMinimizeRecords(
+    MinimizeRecordsArgs);
+std::vector<RecordKMer> NtHashRecoveryUnrolledMinimizeRecords(
+    MinimizeRecordsArgs);
+
+// Nested minimizers for several window lengths from a single hashing pass
+std::vector<std::vector<KMer>> ArgMinRecoveryMinimizeLevels(
+    MinimizeLevelsArgs);
+std::vector<std::vector<KMer>> NtHashRecoveryMinimizeLevels(
+    MinimizeLevelsArgs);
+
+// Rolling k-min-mers projected while sampling, without a minimizer vector.
+// Only the unrolled arg min recovery sampler is wired up; the blocked, multi
+// record and multi level paths do not produce k-min-mers. Robust ties sample
+// the whole sequence at once and keep its full minimizer buffer
+std::vector<KMinMer> ArgMinRecoveryUnrolledMinimizeKMinMers(
+    MinimizeKMinMersArgs);
+std::vector<KMinMer> NtHashRecoveryUnrolledMinimizeKMinMers(
+    MinimizeKMinMersArgs);
+
 }  // namespace tb
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace tb {
+
+enum class HugePages : std::uint8_t {
+  kNone,
+  // madvise(MADV_HUGEPAGE); the kernel promotes aligned 2 MiB ranges
+  kTransparent,
+  // MAP_HUGETLB from the reserved pool, transparent when the pool is empty
+  kExplicit,
+};
+
+struct ArenaOptions {
+  HugePages huge_pages = HugePages::kTransparent;
+  // prefer the NUMA node of the thread that maps a block
+  bool numa_local = true;
+};
+
+// Hands out 2 MiB aligned blocks for large buffers and keeps freed blocks
+// mapped, so later calls reuse memory that is already faulted in. Freed blocks
+// are reused best fit, preferring blocks placed on the caller's NUMA node.
+// Requests below kMinBlockSize go to the global heap. Thread safe.
+class Arena {
+  struct Block {
+    void* ptr;
+    std::size_t size;
+    int node;
+  };
+
+  ArenaOptions options_;
+  mutable std::mutex mutex_;
+  std::vector<Block> live_;
+  std::vector<Block> free_;
+  std::size_t mapped_bytes_ = 0;
+
+  Block Map(std::size_t size, int node) const;
+
+ public:
+  static constexpr std::size_t kHugePageSize = 2uz << 20;
+  static constexpr std::size_t kMinBlockSize = kHugePageSize / 2;
+
+  explicit Arena(ArenaOptions options = {});
+  ~Arena();
+
+  Arena(Arena const&) = delete;
+  Arena& operator=(Arena const&) = delete;
+
+  void* Allocate(std::size_t n_bytes);
+  void Deallocate(void* ptr, std::size_t n_bytes) noexcept;
+
+  // Unmaps every freed block
+  void Release() noexcept;
+
+  // Bytes currently mapped, live and freed
+  std::size_t mapped_bytes() const;
+};
+
+// Allocator drawing from an Arena; falls back to the global heap when the arena
+// is null, so buffers of one type serve both paths
+template <class T>
+class ArenaAllocator {
+  Arena* arena_;
+
+ public:
+  using value_type = T;
+
+  explicit ArenaAllocator(Arena* arena = nullptr) noexcept : arena_(arena) {}
+
+  template <class U>
+  ArenaAllocator(ArenaAllocator<U> const& other) noexcept
+      : arena_(other.arena()) {}
+
+  T* allocate(std::size_t n) {
+    if (!arena_) {
+      return std::allocator<T>{}.allocate(n);
+    }
+
+    return static_cast<T*>(arena_->Allocate(n * sizeof(T)));
+  }
+
+  void deallocate(T* ptr, std::size_t n) noexcept {
+    if (!arena_) {
+      return std::allocator<T>{}.deallocate(ptr, n);
+    }
+
+    arena_->Deallocate(ptr, n * sizeof(T));
+  }
+
+  Arena* arena() const noexcept { return arena_; }
+
+  template <class U>
+  friend bool operator==(ArenaAllocator const& lhs,
+                         ArenaAllocator<U> const& rhs) noexcept {
+    return lhs.arena() == rhs.arena();
+  }
+};
+
+template <class T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+}  // namespace tb
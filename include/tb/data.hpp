@@ -2,6 +2,7 @@
 
 #include <array>
 #include <cstdint>
+#include <span>
 #include <vector>
 
 namespace tb {
@@ -28,13 +29,61 @@ inline constexpr std::array<std::uint8_t, 256> kNucleotideCoder = {
   255,   3, 255, 255, 255, 255, 255, 255
 };
 
+// Composition of generated sequences. Rates are shares of all bases; the
+// rest is background drawn with the given GC content.
+struct MockSequenceProfile {
+  double gc_content = 0.5;
+
+  // short units repeated in place, e.g. microsatellites
+  double tandem_repeat_rate = 0.0;
+  std::size_t max_tandem_unit_length = 8;
+  std::size_t tandem_repeat_length = 200;
+
+  // diverged copies of a few repeat families spread over the sequence
+  double interspersed_repeat_rate = 0.0;
+  std::size_t n_repeat_families = 16;
+  std::size_t repeat_family_length = 300;
+  double repeat_divergence = 0.05;
+
+  // homopolymer and dinucleotide runs
+  double low_complexity_rate = 0.0;
+  std::size_t low_complexity_length = 50;
+
+  // gaps of unknown bases, stored as A like kNucleotideCoder does for N
+  double n_block_rate = 0.0;
+  std::size_t n_block_length = 1000;
+};
+
+inline constexpr MockSequenceProfile kUniformProfile = {};
+
+inline constexpr MockSequenceProfile kHumanLikeProfile = {
+    .gc_content = 0.41,
+    .tandem_repeat_rate = 0.03,
+    .interspersed_repeat_rate = 0.45,
+    .low_complexity_rate = 0.02,
+    .n_block_rate = 0.01,
+};
+
 // biosoup::NucleicAcid like structure
 class MockSequence {
   std::size_t n_bases_;
   std::vector<std::uint64_t> data_;
 
 public:
+  MockSequence() : n_bases_(0) {}
   MockSequence(std::size_t n_bases, int seed);
+  // Generated in parallel chunks; the result depends only on the arguments
+  MockSequence(std::size_t n_bases, int seed,
+               MockSequenceProfile const &profile);
+
+  void push_back(std::uint64_t code) {
+    auto shift = (n_bases_ << 1) & 63;
+    if (shift == 0) {
+      data_.push_back(0);
+    }
+    data_.back() = (data_.back() & ~(3ul << shift)) | (code << shift);
+    ++n_bases_;
+  }
 
   [[gnu::always_inline]] std::uint64_t Code(std::size_t i) const noexcept {
     return ((data_[i >> 5] >> ((i << 1) & 63)) & 3);
@@ -74,4 +123,80 @@ public:
   friend auto operator<=>(KMer const &lhs, KMer const &rhs) = default;
 };
 
+// Records concatenated into a single 2-bit buffer with an offsets table
+class MockSequenceSet {
+  MockSequence seq_;
+  std::vector<std::size_t> offsets_;
+
+public:
+  explicit MockSequenceSet(std::span<MockSequence const> records);
+  MockSequenceSet(std::span<std::size_t const> record_lengths, int seed);
+
+  MockSequence const &sequence() const noexcept { return seq_; }
+
+  std::size_t offset(std::size_t record_id) const noexcept {
+    return offsets_[record_id];
+  }
+  std::size_t record_size(std::size_t record_id) const noexcept {
+    return offsets_[record_id + 1] - offsets_[record_id];
+  }
+
+  std::size_t size() const noexcept { return offsets_.size() - 1; }
+};
+
+// KMer addressed by its record and the position local to that record
+class RecordKMer {
+  KMer::value_type value_;
+  std::uint32_t record_id_;
+  std::uint32_t pos_strand_;
+
+public:
+  using value_type = KMer::value_type;
+  using position_type = KMer::position_type;
+
+  RecordKMer() = default;
+  [[gnu::always_inline]] RecordKMer(value_type value, std::uint32_t record_id,
+                                    position_type pos, bool strand)
+      : value_(value), record_id_(record_id),
+        pos_strand_((static_cast<std::uint32_t>(strand) << 31) | pos) {}
+
+  [[gnu::always_inline]] value_type value() const noexcept { return value_; }
+  [[gnu::always_inline]] std::uint32_t record_id() const noexcept {
+    return record_id_;
+  }
+  [[gnu::always_inline]] position_type position() const noexcept {
+    return pos_strand_ & ((1u << 31u) - 1u);
+  }
+  [[gnu::always_inline]] bool strand() const noexcept {
+    return (pos_strand_ >> 31) & 1;
+  }
+
+  friend auto operator<=>(RecordKMer const &lhs,
+                          RecordKMer const &rhs) = default;
+};
+
+// Hash of consecutive minimizers covering the bases [start, end)
+class KMinMer {
+  KMer::value_type value_;
+  KMer::position_type start_;
+  KMer::position_type end_;
+
+public:
+  using value_type = KMer::value_type;
+  using position_type = KMer::position_type;
+
+  KMinMer() = default;
+  [[gnu::always_inline]] KMinMer(value_type value, position_type start,
+                                 position_type end)
+      : value_(value), start_(start), end_(end) {}
+
+  [[gnu::always_inline]] value_type value() const noexcept { return value_; }
+  [[gnu::always_inline]] position_type start() const noexcept {
+    return start_;
+  }
+  [[gnu::always_inline]] position_type end() const noexcept { return end_; }
+
+  friend auto operator<=>(KMinMer const &lhs, KMinMer const &rhs) = default;
+};
+
 } // namespace tb
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "tb/data.hpp"
+
+namespace tb {
+
+// Seed hit shared by a query and a reference record, ready for chaining
+struct Anchor {
+  std::uint32_t record_id;
+  KMer::position_type reference_position;
+  KMer::position_type query_position;
+
+  std::int64_t diagonal() const noexcept {
+    return static_cast<std::int64_t>(reference_position) - query_position;
+  }
+
+  friend auto operator<=>(Anchor const& lhs, Anchor const& rhs) = default;
+};
+
+// Open addressing hash table from minimizer hash to reference locations
+class MinimizerIndex {
+  struct Location {
+    std::uint32_t record_id;
+    KMer::position_type position;
+  };
+
+  // `count == 0` marks an empty bucket
+  struct Bucket {
+    KMer::value_type value;
+    std::uint32_t begin;
+    std::uint32_t count;
+  };
+
+  std::vector<Bucket> buckets_;
+  std::vector<Location> locations_;
+  int shift_;
+
+  std::size_t Slot(KMer::value_type value) const noexcept {
+    return (value * 0x9e37'79b9'7f4a'7c15ull) >> shift_;
+  }
+
+ public:
+  // Minimizers occurring more than `max_occurrences` times are left out
+  explicit MinimizerIndex(
+      std::span<RecordKMer const> minimizers,
+      std::size_t max_occurrences = std::numeric_limits<std::uint32_t>::max());
+
+  // Probes are software pipelined with prefetches; anchors are sorted by
+  // (record_id, diagonal) and by query position within a diagonal
+  std::vector<Anchor> Query(std::span<KMer const> minimizers) const;
+
+  std::size_t size() const noexcept { return locations_.size(); }
+};
+
+}  // namespace tb
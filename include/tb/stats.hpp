@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace tb {
+
+// Heap activity of the calling thread while a MemoryStatsScope is alive
+struct MemoryStats {
+  std::size_t n_allocations;
+  std::size_t allocated_bytes;
+  // high water mark of live heap bytes above the level at scope entry
+  std::size_t peak_bytes;
+  // process wide peak resident set size at scope exit
+  std::size_t peak_rss_bytes;
+};
+
+// Fills `dst` on destruction; does nothing if `dst` is null
+class MemoryStatsScope {
+  MemoryStats* dst_;
+  std::size_t n_allocations_;
+  std::size_t allocated_bytes_;
+  std::int64_t live_bytes_;
+  std::int64_t peak_bytes_;
+
+ public:
+  explicit MemoryStatsScope(MemoryStats* dst) noexcept;
+  ~MemoryStatsScope();
+
+  MemoryStatsScope(MemoryStatsScope const&) = delete;
+  MemoryStatsScope& operator=(MemoryStatsScope const&) = delete;
+};
+
+// Peak resident set size of the process in bytes
+std::size_t PeakRss();
+
+// Restarts peak resident set size tracking from the current resident set
+void ResetPeakRss();
+
+}  // namespace tb
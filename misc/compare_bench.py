@@ -0,0 +1,89 @@
+#!/usr/bin/env python3
+"""Compares Google Benchmark JSON output against a stored baseline.
+
+Exits with a non-zero status if any benchmark present in both files got
+slower than the baseline by more than the threshold. Baselines are machine
+specific; when the baseline file does not exist yet the current results are
+stored as the baseline and nothing is compared.
+
+    ./build/bin/bench --benchmark_out=bench.json
+    ./misc/compare_bench.py build/bench_baseline.json bench.json
+    ./misc/compare_bench.py --update build/bench_baseline.json bench.json
+"""
+
+import argparse
+import json
+import os
+import shutil
+import sys
+
+
+def load_times(path, metric):
+    with open(path) as f:
+        benchmarks = json.load(f)["benchmarks"]
+
+    # the median aggregate is preferred over single iterations wherever the
+    # run was repeated, regardless of where it appears in the file
+    medians = {
+        bench["run_name"]: bench[metric]
+        for bench in benchmarks
+        if bench.get("run_type") == "aggregate"
+        and bench.get("aggregate_name") == "median"
+    }
+    times = {}
+    for bench in benchmarks:
+        if bench.get("run_type") == "aggregate":
+            continue
+        times[bench["run_name"]] = bench[metric]
+    times.update(medians)
+
+    return times
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("baseline", help="stored baseline benchmark json")
+    parser.add_argument("current", help="fresh benchmark json")
+    parser.add_argument("--threshold", type=float, default=0.10,
+                        help="allowed relative slowdown (default: 0.10)")
+    parser.add_argument("--metric", default="cpu_time",
+                        choices=["cpu_time", "real_time"])
+    parser.add_argument("--update", action="store_true",
+                        help="replace the baseline with the current results")
+    args = parser.parse_args()
+
+    if args.update:
+        shutil.copyfile(args.current, args.baseline)
+        print(f"baseline updated: {args.baseline}")
+        return 0
+
+    if not os.path.exists(args.baseline):
+        shutil.copyfile(args.current, args.baseline)
+        print(f"no baseline at {args.baseline}; stored the current results, "
+              "rerun to compare against them")
+        return 0
+
+    baseline = load_times(args.baseline, args.metric)
+    current = load_times(args.current, args.metric)
+
+    n_regressions = 0
+    width = max(map(len, current), default=0)
+    for name, time in current.items():
+        if name not in baseline:
+            print(f"{name:<{width}}  {'new':>8}")
+            continue
+
+        ratio = time / baseline[name]
+        regressed = ratio > 1.0 + args.threshold
+        n_regressions += regressed
+        print(f"{name:<{width}}  {ratio:>8.3f}  {'FAIL' if regressed else 'ok'}")
+
+    for name in baseline.keys() - current.keys():
+        print(f"{name:<{width}}  {'missing':>8}")
+
+    print(f"{n_regressions} regression(s) above {args.threshold:.0%}")
+    return 1 if n_regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -2,10 +2,13 @@
 
 #include <algorithm>
 #include <array>
-#include <cassert>
+#include <bit>
 #include <concepts>
 #include <deque>
+#include <ranges>
 #include <span>
+#include <stdexcept>
+#include <utility>
 
 #include "tb/nthash.hpp"
 
@@ -16,7 +19,7 @@ namespace {
 constexpr auto calc_mask =
     [] [[using gnu: always_inline, const]] (
         std::uint32_t kmer_length) constexpr noexcept -> std::uint64_t {
-  return (1 << (kmer_length * 2)) - 1;
+  return ~0ull >> (64 - 2 * kmer_length);
 };
 
 // Thomas Wang integer hash function
@@ -34,86 +37,169 @@ constexpr auto hash =
   return key;
 };
 
+// Comparators resolving equal hashes for a TiePolicy. `scan` picks the minimum
+// of a whole window, `slide` decides whether the hash entering the window
+// replaces the current minimum. Sticky policies keep the previous minimizer
+// while it is still in the window and ties with the window minimum.
+template <class ScanCompare, class SlideCompare, bool Sticky>
+struct Ties {
+  static constexpr ScanCompare scan{};
+  static constexpr SlideCompare slide{};
+  static constexpr bool kSticky = Sticky;
+};
+
+using LeftmostTies = Ties<std::less<>, std::less<>, false>;
+using RightmostTies = Ties<std::less_equal<>, std::less_equal<>, false>;
+using RobustTies = Ties<std::less_equal<>, std::less<>, true>;
+
+constexpr auto with_ties = [](TiePolicy policy, auto&& fn) {
+  switch (policy) {
+    case TiePolicy::kRightmost:
+      return fn(RightmostTies{});
+    case TiePolicy::kRobust:
+      return fn(RobustTies{});
+    case TiePolicy::kLeftmost:
+      break;
+  }
+  return fn(LeftmostTies{});
+};
+
+// Capacity for the minimizers of `n_kmers` kmers. Random sequences average
+// 2 / (w + 1) minimizers per kmer and real ones scatter around it, so the
+// estimate keeps 25% headroom rather than doubling when it runs over.
+constexpr auto reserve_minimizers =
+    [] [[using gnu: always_inline, const]] (
+        std::size_t n_kmers,
+        std::int32_t window_length) constexpr noexcept -> std::size_t {
+  return 5 * n_kmers / (2 * (window_length + 1)) + 64;
+};
+
+constexpr auto keeps_previous =
+    []<class T> [[using gnu: always_inline]] (
+        T, KMer const& prev, std::int64_t window_begin,
+        KMer::value_type min_hash) constexpr noexcept -> bool {
+  return T::kSticky && prev.position() >= window_begin &&
+         prev.value() == min_hash;
+};
+
 }  // namespace
 
 std::vector<KMer> NaiveMinimize(MinimizeArgs args) {
-  std::vector<KMer> dst;
-  if (args.seq.size() < args.window_length + args.kmer_length - 2) {
-    return dst;
-  }
+  MemoryStatsScope scope(args.stats);
+  return with_ties(args.tie_policy, [args]<class T>(T ties) {
+    std::vector<KMer> dst;
+    if (args.seq.size() < args.window_length + args.kmer_length - 1) {
+      return dst;
+    }
 
-  dst.reserve(args.seq.size());
-  auto const mask = calc_mask(args.kmer_length);
-  for (std::size_t i = 0; i + args.kmer_length < args.seq.size(); ++i) {
-    KMer::value_type min_hash;
-    KMer::position_type min_position = args.seq.size();
-    for (std::size_t j = 0; j < args.window_length &&
-                            i + j + args.kmer_length - 1 < args.seq.size();
-         ++j) {
-      KMer::value_type value;
-      for (std::size_t k = 0; k < args.kmer_length; ++k) {
-        value = (value << 2) | args.seq.Code(i + j + k);
-      }
+    dst.reserve(args.seq.size());
+    auto const mask = calc_mask(args.kmer_length);
+    for (std::size_t i = 0;
+         i + args.window_length + args.kmer_length - 1 <= args.seq.size();
+         ++i) {
+      KMer::value_type min_hash;
+      KMer::position_type min_position = args.seq.size();
+      for (std::size_t j = 0; j < args.window_length; ++j) {
+        KMer::value_type value = 0;
+        for (std::size_t k = 0; k < args.kmer_length; ++k) {
+          value = (value << 2) | args.seq.Code(i + j + k);
+        }
 
-      auto hash_value = hash(value, mask);
-      if (min_position == args.seq.size() || hash_value < min_hash) {
-        min_hash = hash_value;
-        min_position = i + j;
+        auto hash_value = hash(value, mask);
+        if (min_position == args.seq.size() ||
+            T::scan(hash_value, min_hash)) {
+          min_hash = hash_value;
+          min_position = i + j;
+        }
+      }
+      if (!dst.empty() && keeps_previous(ties, dst.back(), i, min_hash)) {
+        min_position = dst.back().position();
+      }
+      if (dst.empty() || dst.back().position() != min_position) {
+        dst.emplace_back(min_hash, min_position, 0);
       }
     }
-    if (dst.empty() || dst.back().position() != min_position) {
-      dst.emplace_back(min_hash, min_position, 0);
-    }
-  }
 
-  return dst;
+    return dst;
+  });
 }
 
 std::vector<KMer> DequeMinimize(MinimizeArgs args) {
-  std::vector<KMer> dst;
-  if (args.seq.size() < args.window_length + args.kmer_length - 2) {
-    return dst;
-  }
+  MemoryStatsScope scope(args.stats);
+  return with_ties(args.tie_policy, [args]<class T>(T ties) {
+    std::vector<KMer> dst;
+    if (args.seq.size() < args.window_length + args.kmer_length - 1) {
+      return dst;
+    }
 
-  dst.reserve(args.seq.size());
-  auto const mask = calc_mask(args.kmer_length);
-  std::deque<KMer> window;
+    dst.reserve(args.seq.size());
+    auto const mask = calc_mask(args.kmer_length);
+    std::deque<KMer> window;
 
-  auto push = [&window](KMer::value_type hash_value,
-                        KMer::position_type position) -> void {
-    while (!window.empty() && window.back().value() > hash_value) {
-      window.pop_back();
-    }
-    window.emplace_back(hash_value, position, 0);
-  };
+    // equal hashes are popped only when the rightmost one should win
+    auto push = [&window](KMer::value_type hash_value,
+                          KMer::position_type position) -> void {
+      while (!window.empty() && T::scan(hash_value, window.back().value())) {
+        window.pop_back();
+      }
+      window.emplace_back(hash_value, position, 0);
+    };
 
-  auto pop = [&window, w = args.window_length](KMer::position_type position) {
-    if (window.front().position() <= position - w) {
-      window.pop_front();
-    }
-  };
+    auto pop = [&window, w = args.window_length](KMer::position_type position) {
+      if (window.front().position() <= position - w) {
+        window.pop_front();
+      }
+    };
 
-  KMer::value_type value;
-  for (std::size_t i = 0; i < args.seq.size(); ++i) {
-    if (i >= args.window_length + args.kmer_length - 1) {
-      pop(i - (args.kmer_length - 1));
-    }
+    KMer::value_type value = 0;
+    for (std::size_t i = 0; i < args.seq.size(); ++i) {
+      if (i >= args.window_length + args.kmer_length - 1) {
+        pop(i - (args.kmer_length - 1));
+      }
 
-    value = ((value << 2) | args.seq.Code(i)) & mask;
-    if (i >= args.kmer_length - 1) {
-      push(hash(value, mask), i - (args.kmer_length - 1));
-      if (i > args.window_length + args.kmer_length - 2 &&
-          (dst.empty() || dst.back().position() != window.front().position())) {
-        dst.emplace_back(window.front().value(), window.front().position(), 0);
+      value = ((value << 2) | args.seq.Code(i)) & mask;
+      if (i >= args.kmer_length - 1) {
+        push(hash(value, mask), i - (args.kmer_length - 1));
+        if (i >= args.window_length + args.kmer_length - 2) {
+          auto min = window.front();
+          if (!dst.empty() &&
+              keeps_previous(ties, dst.back(),
+                             i - (args.kmer_length - 1) -
+                                 (args.window_length - 1),
+                             min.value())) {
+            min = dst.back();
+          }
+          if (dst.empty() || dst.back().position() != min.position()) {
+            dst.push_back(min);
+          }
+        }
       }
     }
-  }
 
-  return dst;
+    return dst;
+  });
 }
 
 namespace {
 
+// Runs `sample` over a buffer of `size` kmers and returns the written prefix.
+// Without an arena the buffer itself is trimmed and returned; with one it stays
+// in the arena for the next call and the prefix is copied out.
+template <class Sample>
+std::vector<KMer> sample_into(Arena* arena, std::size_t size, Sample sample) {
+  if (!arena) {
+    std::vector<KMer> dst(size);
+    dst.resize(sample(std::span(dst)));
+    return dst;
+  }
+
+  ArenaVector<KMer> buffer(size, ArenaAllocator<KMer>(arena));
+  auto n_dst = sample(std::span(buffer));
+  return std::vector<KMer>(buffer.begin(), buffer.begin() + n_dst);
+}
+
+// Samplers write at most one minimizer per hash into `dst` and return the
+// number of minimizers written; positions are relative to `hashes`.
 template <class Hasher, class Sampler>
 class ArgMinMixinBase {
   [[no_unique_address]] Hasher hasher_;
@@ -121,21 +207,77 @@ class ArgMinMixinBase {
 
  public:
   std::vector<KMer> operator()(MinimizeArgs args) const {
-    if (args.seq.size() < args.window_length + args.kmer_length - 2) {
+    if (args.seq.size() < args.window_length + args.kmer_length - 1) {
       return {};
     }
 
-    return sampler_(args, hasher_(args));
+    auto hashes = hasher_(args, ArenaAllocator<KMer::value_type>(args.arena));
+    return sample_into(args.arena, hashes.size(), [&](std::span<KMer> dst) {
+      return sampler_(args, hashes, dst);
+    });
+  }
+};
+
+// Hashes the whole concatenation once and samples each record's own kmers;
+// kmers spanning a record boundary are hashed but never sampled.
+template <class Hasher, class Sampler>
+class RecordsMixinBase {
+  [[no_unique_address]] Hasher hasher_;
+  [[no_unique_address]] Sampler sampler_;
+
+ public:
+  std::vector<RecordKMer> operator()(MinimizeRecordsArgs args) const {
+    auto seq_args = MinimizeArgs{
+        .seq = args.records.sequence(),
+        .window_length = args.window_length,
+        .kmer_length = args.kmer_length,
+        .tie_policy = args.tie_policy,
+        .arena = args.arena,
+    };
+    if (seq_args.seq.size() < args.window_length + args.kmer_length - 1) {
+      return {};
+    }
+
+    auto hashes =
+        hasher_(seq_args, ArenaAllocator<KMer::value_type>(args.arena));
+    std::size_t max_record_size = 0;
+    for (std::size_t i = 0; i < args.records.size(); ++i) {
+      max_record_size = std::max(max_record_size, args.records.record_size(i));
+    }
+
+    ArenaVector<KMer> kmers(max_record_size, ArenaAllocator<KMer>(args.arena));
+    std::vector<RecordKMer> dst;
+    dst.reserve(reserve_minimizers(hashes.size(), args.window_length));
+    for (std::uint32_t i = 0; i < args.records.size(); ++i) {
+      std::int64_t n_kmers =
+          std::int64_t(args.records.record_size(i)) - args.kmer_length + 1;
+      if (n_kmers < args.window_length) {
+        continue;
+      }
+
+      auto n_dst =
+          sampler_(seq_args,
+                   std::span(hashes).subspan(args.records.offset(i), n_kmers),
+                   kmers);
+      for (std::size_t j = 0; j < n_dst; ++j) {
+        dst.emplace_back(kmers[j].value(), i, kmers[j].position(),
+                         kmers[j].strand());
+      }
+    }
+
+    return dst;
   }
 };
 
 struct ThomasWangHasher {
-  std::vector<KMer::value_type> operator()(MinimizeArgs args) const {
+  template <class Allocator = std::allocator<KMer::value_type>>
+  std::vector<KMer::value_type, Allocator> operator()(
+      MinimizeArgs args, Allocator const& alloc = Allocator()) const {
     auto const mask = calc_mask(args.kmer_length);
 
-    KMer::value_type value;
-    std::vector<KMer::value_type> hashes(args.seq.size() - args.kmer_length +
-                                         1);
+    KMer::value_type value = 0;
+    std::vector<KMer::value_type, Allocator> hashes(
+        args.seq.size() - args.kmer_length + 1, alloc);
     for (std::size_t i = 0; i < args.seq.size(); ++i) {
       value = ((value << 2) | args.seq.Code(i)) & mask;
       if (i >= args.kmer_length - 1) {
@@ -148,9 +290,11 @@ struct ThomasWangHasher {
 };
 
 struct NtHasher {
-  std::vector<KMer::value_type> operator()(MinimizeArgs args) const {
-    if (args.seq.size() < args.window_length + args.kmer_length - 2) {
-      return {};
+  template <class Allocator = std::allocator<KMer::value_type>>
+  std::vector<KMer::value_type, Allocator> operator()(
+      MinimizeArgs args, Allocator const& alloc = Allocator()) const {
+    if (args.seq.size() < args.kmer_length) {
+      return std::vector<KMer::value_type, Allocator>(alloc);
     }
 
     KMer::value_type value =
@@ -159,8 +303,8 @@ struct NtHasher {
       value ^= srol(kNtHashSeeds[args.seq.Code(i)], args.kmer_length - (i + 1));
     }
 
-    std::vector<KMer::value_type> hashes(args.seq.size() - args.kmer_length +
-                                         1);
+    std::vector<KMer::value_type, Allocator> hashes(
+        args.seq.size() - args.kmer_length + 1, alloc);
     hashes[0] = value;
 
     for (std::int64_t i = args.kmer_length; i < args.seq.size(); ++i) {
@@ -174,15 +318,16 @@ struct NtHasher {
 };
 
 class NtHasherOpt {
-  template <std::size_t N>
-  std::vector<KMer::value_type> impl(MinimizeArgs args) const {
+  template <std::size_t N, class Allocator>
+  std::vector<KMer::value_type, Allocator> impl(MinimizeArgs args,
+                                                Allocator const& alloc) const {
     using RegType = Reg<N>;
     if (args.seq.size() < N * args.kmer_length) {
-      return NtHasher{}(args);
+      return NtHasher{}(args, alloc);
     }
 
     std::int64_t n_kmers = args.seq.size() - args.kmer_length + 1;
-    std::vector<KMer::value_type> dst(n_kmers);
+    std::vector<KMer::value_type, Allocator> dst(n_kmers, alloc);
 
     auto pivots = [n_kmers] {
       std::array<std::int64_t, N> pivots;
@@ -251,8 +396,10 @@ class NtHasherOpt {
   }
 
  public:
-  std::vector<KMer::value_type> operator()(MinimizeArgs args) const {
-    return impl<4>(args);
+  template <class Allocator = std::allocator<KMer::value_type>>
+  std::vector<KMer::value_type, Allocator> operator()(
+      MinimizeArgs args, Allocator const& alloc = Allocator()) const {
+    return impl<4>(args, alloc);
   }
 };
 
@@ -263,12 +410,12 @@ concept AMinElement = requires(T lhs, T rhs) {
 };
 
 struct PredicationMinElement {
-  template <AMinElement T>
+  template <AMinElement T, class Compare = std::less<>>
   constexpr std::span<T>::iterator operator()(
-      std::span<T> span) const noexcept {
+      std::span<T> span, Compare compare = {}) const noexcept {
     auto idx = 0;
     for (std::size_t jdx = 0; jdx < span.size(); ++jdx) {
-      auto c = span[jdx] < span[idx];
+      auto c = compare(span[jdx], span[idx]);
       idx = c * jdx + (1 - c) * idx;
     }
 
@@ -281,22 +428,27 @@ class ArgMinSampler {
   [[no_unique_address]] MinPolicy min_element_;
 
  public:
-  std::vector<KMer> operator()(
-      MinimizeArgs args, std::vector<KMer::value_type> hashes) const noexcept {
-    std::vector<KMer> dst(hashes.size());
-    std::int64_t idx = -1;
-    for (std::size_t i = args.window_length; i <= hashes.size(); ++i) {
-      auto window = std::span(hashes.begin() + i - args.window_length,
-                              hashes.begin() + i);
-      if (auto min_pos =
-              min_element_(window) - window.begin() + i - args.window_length;
-          idx == -1 || dst[idx].position() != min_pos) {
-        dst[++idx] = KMer(hashes[min_pos], min_pos, 0);
+  std::size_t operator()(MinimizeArgs args,
+                         std::span<KMer::value_type> hashes,
+                         std::span<KMer> dst) const noexcept {
+    return with_ties(args.tie_policy, [&]<class T>(T ties) -> std::size_t {
+      std::int64_t idx = -1;
+      for (std::size_t i = args.window_length; i <= hashes.size(); ++i) {
+        auto window = std::span(hashes.begin() + i - args.window_length,
+                                hashes.begin() + i);
+        std::int64_t min_pos = min_element_(window, T::scan) - window.begin() +
+                               i - args.window_length;
+        if (idx != -1 && keeps_previous(ties, dst[idx], i - args.window_length,
+                                        hashes[min_pos])) {
+          min_pos = dst[idx].position();
+        }
+        if (idx == -1 || dst[idx].position() != min_pos) {
+          dst[++idx] = KMer(hashes[min_pos], min_pos, 0);
+        }
       }
-    }
 
-    dst.resize(idx + 1);
-    return dst;
+      return idx + 1;
+    });
   }
 };
 
@@ -305,32 +457,36 @@ class ArgMinRecoverySampler {
   [[no_unique_address]] MinPolicy min_element_;
 
  public:
-  std::vector<KMer> operator()(
-      MinimizeArgs args, std::vector<KMer::value_type> hashes) const noexcept {
-    std::vector<KMer> dst(hashes.size());
-    std::size_t min_pos =
-        std::min_element(hashes.begin(), hashes.begin() + args.window_length) -
-        hashes.begin();
-    dst[0] = KMer(hashes[min_pos], min_pos, 0);
-
-    std::size_t idx = 1;
-    for (std::size_t i = args.window_length + 1; i <= hashes.size(); ++i) {
-      bool cond = 1;
-      if (min_pos >= i - args.window_length) {
-        cond = hashes[i - 1] < hashes[min_pos];
-        min_pos = cond * (i - 1) + (!cond) * min_pos;
-      } else {
-        auto window = std::span(hashes.begin() + i - args.window_length,
-                                hashes.begin() + i);
-        min_pos =
-            min_element_(window) - window.begin() + i - args.window_length;
+  // The minimum only moves while it stays inside the window, so sticky
+  // policies need no extra bookkeeping: `slide` already keeps it on ties.
+  std::size_t operator()(MinimizeArgs args,
+                         std::span<KMer::value_type> hashes,
+                         std::span<KMer> dst) const noexcept {
+    return with_ties(args.tie_policy, [&]<class T>(T) -> std::size_t {
+      auto first_window =
+          std::span(hashes.begin(), hashes.begin() + args.window_length);
+      std::size_t min_pos =
+          min_element_(first_window, T::scan) - first_window.begin();
+      dst[0] = KMer(hashes[min_pos], min_pos, 0);
+
+      std::size_t idx = 1;
+      for (std::size_t i = args.window_length + 1; i <= hashes.size(); ++i) {
+        bool cond = 1;
+        if (min_pos >= i - args.window_length) {
+          cond = T::slide(hashes[i - 1], hashes[min_pos]);
+          min_pos = cond * (i - 1) + (!cond) * min_pos;
+        } else {
+          auto window = std::span(hashes.begin() + i - args.window_length,
+                                  hashes.begin() + i);
+          min_pos = min_element_(window, T::scan) - window.begin() + i -
+                    args.window_length;
+        }
+        dst[idx] = KMer(hashes[min_pos], min_pos, 0);
+        idx += cond;
       }
-      dst[idx] = KMer(hashes[min_pos], min_pos, 0);
-      idx += cond;
-    }
 
-    dst.resize(idx);
-    return dst;
+      return idx;
+    });
   }
 };
 
@@ -339,24 +495,25 @@ class UnrolledSampler {
   static constexpr std::size_t kMaxW = 31;
   static constexpr std::size_t kJumpTblSize = kMaxW + 2uz;
 
-  using ImplPtr = std::vector<KMer> (*)(MinimizeArgs,
-                                        std::vector<KMer::value_type>);
+  using ImplPtr = std::size_t (*)(MinimizeArgs, std::span<KMer::value_type>,
+                                  std::span<KMer>);
 
   template <std::size_t I>
   static constexpr auto ImplGenerator = []() -> ImplPtr {
-    return +[](MinimizeArgs args,
-               std::vector<KMer::value_type> hashes) -> std::vector<KMer> {
+    return +[](MinimizeArgs args, std::span<KMer::value_type> hashes,
+               std::span<KMer> dst) -> std::size_t {
       return Sampler<decltype([] [[using gnu: always_inline, hot, const]] (
-                                  std::span<KMer::value_type> span) {
+                                  std::span<KMer::value_type> span,
+                                  auto compare) {
         auto min = 0;
         [&]<std::size_t... Is>(std::index_sequence<Is...>) {
           (..., [&](auto j) {
-            auto c = span[j] < span[min];
+            auto c = compare(span[j], span[min]);
             min = c * j + (1 - c) * min;
           }(Is));
         }(std::make_index_sequence<I>{});
         return span.begin() + min;
-      })>{}(args, std::move(hashes));
+      })>{}(args, hashes, dst);
     };
   };
 
@@ -370,20 +527,22 @@ class UnrolledSampler {
   }();
 
  public:
-  std::vector<KMer> operator()(
-      MinimizeArgs args, std::vector<KMer::value_type> hashes) const noexcept {
-    return kJumpTable[args.window_length](args, std::move(hashes));
+  std::size_t operator()(MinimizeArgs args,
+                         std::span<KMer::value_type> hashes,
+                         std::span<KMer> dst) const noexcept {
+    return kJumpTable[args.window_length](args, hashes, dst);
   }
 };
 
 class SplitWindow {
-  std::vector<KMer> impl(MinimizeArgs args,
-                         std::vector<KMer::value_type> hashes) const {
+  template <class T>
+  std::size_t impl(T ties, MinimizeArgs args,
+                   std::span<KMer::value_type> hashes,
+                   std::span<KMer> dst) const {
     if (hashes.empty()) {
-      return {};
+      return 0;
     }
 
-    std::vector<KMer> dst(hashes.size());
     std::int64_t idx = 0;
 
     std::vector<std::int64_t> lhs(args.window_length + 1);
@@ -394,15 +553,15 @@ class SplitWindow {
 
     auto shift_stacks = [&] {
       for (; rhs_idx > 1; --rhs_idx) {
-        auto cond = lhs_idx == 1 ||
-                    hashes[rhs[rhs_idx - 1]] <= hashes[lhs[lhs_idx - 1]];
+        auto cond = lhs_idx == 1 || !T::scan(hashes[lhs[lhs_idx - 1]],
+                                             hashes[rhs[rhs_idx - 1]]);
         lhs[lhs_idx++] =
             cond * rhs[rhs_idx - 1] + (1 - cond) * lhs[lhs_idx - 1];
       }
     };
 
     auto push_back = [&](std::int64_t i) {
-      rhs_min = hashes[i] < hashes[rhs_min] ? i : rhs_min;
+      rhs_min = T::scan(hashes[i], hashes[rhs_min]) ? i : rhs_min;
       rhs[rhs_idx++] = i;
     };
 
@@ -426,10 +585,14 @@ class SplitWindow {
       for (std::int64_t j = 0; j < args.window_length && i + j < hashes.size();
            ++j) {
         push_back(i + j);
-        auto min_pos =
-            lhs_idx > 1 && hashes[lhs[lhs_idx - 1]] <= hashes[rhs_min]
+        std::int64_t min_pos =
+            lhs_idx > 1 && !T::scan(hashes[rhs_min], hashes[lhs[lhs_idx - 1]])
                 ? lhs[lhs_idx - 1]
                 : rhs_min;
+        if (keeps_previous(ties, dst[idx - 1], i + j - args.window_length + 1,
+                           hashes[min_pos])) {
+          min_pos = dst[idx - 1].position();
+        }
         if (dst[idx - 1].position() != min_pos) {
           dst[idx++] = KMer(hashes[min_pos], min_pos, 0);
         }
@@ -438,14 +601,503 @@ class SplitWindow {
       }
     }
 
-    dst.resize(idx);
+    return idx;
+  }
+
+ public:
+  std::size_t operator()(MinimizeArgs args, std::span<KMer::value_type> hashes,
+                         std::span<KMer> dst) const {
+    return with_ties(args.tie_policy,
+                     [&](auto ties) { return impl(ties, args, hashes, dst); });
+  }
+};
+
+// Fuses NtHasherOpt with recovery sampling. Sampled windows are split into N
+// contiguous lanes hashed in lockstep; each lane keeps only an L1 sized tile
+// of hashes (plus w - 1 carried over) which is sampled as soon as it fills.
+template <class MinPolicy>
+class BlockedNtHashMixinBase {
+  static constexpr std::size_t kNLanes = 4uz;
+  static constexpr std::int64_t kTileSize = 1024;
+
+  [[no_unique_address]] MinPolicy min_element_;
+
+  struct Lane {
+    std::int64_t first_window;
+    std::int64_t next_window;
+    std::int64_t end_window;
+    std::int64_t next_kmer;
+    std::int64_t end_kmer;
+    // kmer position of tile[0]
+    std::int64_t tile_pos;
+    std::int64_t tile_fill;
+    std::int64_t min_pos;
+    // minimizers of this lane's windows, stitched together at the end
+    std::vector<KMer> dst;
+  };
+
+  template <class T>
+  void sample(MinimizeArgs args, Lane& lane,
+              std::vector<KMer::value_type>& tile) const {
+    auto at = [&](std::int64_t pos) -> KMer::value_type& {
+      return tile[pos - lane.tile_pos];
+    };
+
+    auto emit = [&] {
+      if (lane.dst.empty() || lane.dst.back().position() != lane.min_pos) {
+        lane.dst.emplace_back(at(lane.min_pos), lane.min_pos, 0);
+      }
+    };
+
+    for (; lane.next_window < lane.end_window &&
+           lane.next_window + args.window_length <=
+               lane.tile_pos + lane.tile_fill;
+         ++lane.next_window) {
+      auto i = lane.next_window;
+      if (i != lane.first_window && lane.min_pos >= i) {
+        auto cond =
+            T::slide(at(i + args.window_length - 1), at(lane.min_pos));
+        lane.min_pos = cond * (i + args.window_length - 1) +
+                       (1 - cond) * lane.min_pos;
+      } else {
+        auto window = std::span(tile.begin() + (i - lane.tile_pos),
+                                tile.begin() + (i - lane.tile_pos) +
+                                    args.window_length);
+        lane.min_pos = min_element_(window, T::scan) - window.begin() + i;
+      }
+      emit();
+    }
+
+    // keep the last w - 1 hashes for windows spanning the next tile
+    auto keep = std::min<std::int64_t>(lane.tile_fill, args.window_length - 1);
+    std::copy(tile.begin() + lane.tile_fill - keep,
+              tile.begin() + lane.tile_fill, tile.begin());
+    lane.tile_pos += lane.tile_fill - keep;
+    lane.tile_fill = keep;
+  }
+
+  // Sticky ties make the choice in a window depend on the previous window, so a
+  // lane sampled from a cold start may disagree with the sequential chain near
+  // its first window. Both chains agree from the first minimizer they share
+  // onwards; until then the sequential chain is rerun with scalar hashing.
+  // Returns the number of lane minimizers consumed.
+  template <class T>
+  std::size_t repair(MinimizeArgs args, Lane const& lane,
+                     std::vector<KMer>& dst) const {
+    auto const w = args.window_length;
+    auto const k = args.kmer_length;
+
+    std::vector<KMer::value_type> ring(w);
+    auto at = [&](std::int64_t pos) -> KMer::value_type& {
+      return ring[pos % w];
+    };
+
+    KMer::value_type value = 0;
+    auto next_kmer = lane.first_window;
+    auto hash_until = [&](std::int64_t end) {
+      for (; next_kmer < end; ++next_kmer) {
+        if (next_kmer == lane.first_window) {
+          for (std::int64_t j = 0; j < k; ++j) {
+            value ^= srol(kNtHashSeeds[args.seq.Code(next_kmer + j)],
+                          k - (j + 1));
+          }
+        } else {
+          value = nthash(value, args.seq.Code(next_kmer - 1),
+                         args.seq.Code(next_kmer + k - 1), k);
+        }
+        at(next_kmer) = value;
+      }
+    };
+
+    std::size_t lane_idx = 0;
+    std::int64_t min_pos = dst.back().position();
+    for (auto i = lane.first_window; i < lane.end_window; ++i) {
+      hash_until(i + w);
+      if (min_pos >= i) {
+        auto cond = T::slide(at(i + w - 1), at(min_pos));
+        min_pos = cond * (i + w - 1) + (1 - cond) * min_pos;
+      } else {
+        min_pos = i;
+        for (auto pos = i + 1; pos < i + w; ++pos) {
+          min_pos = T::scan(at(pos), at(min_pos)) ? pos : min_pos;
+        }
+      }
+
+      if (i == lane.first_window && lane.dst.front().position() == min_pos) {
+        return 0;
+      }
+
+      if (dst.back().position() != min_pos) {
+        dst.emplace_back(at(min_pos), min_pos, 0);
+      }
+
+      for (; lane_idx < lane.dst.size() &&
+             lane.dst[lane_idx].position() < min_pos;
+           ++lane_idx);
+      if (lane_idx < lane.dst.size() &&
+          lane.dst[lane_idx].position() == min_pos) {
+        dst.insert(dst.end(), lane.dst.begin() + lane_idx + 1, lane.dst.end());
+        break;
+      }
+    }
+
+    return lane.dst.size();
+  }
+
+  template <class T>
+  std::vector<KMer> impl(MinimizeArgs args) const {
+    std::int64_t n_kmers = args.seq.size() - args.kmer_length + 1;
+    std::int64_t n_windows = n_kmers - args.window_length + 1;
+    if (n_windows <= 0) {
+      return {};
+    }
+
+    if (n_windows < kNLanes) {
+      return ArgMinMixinBase<NtHasher, ArgMinRecoverySampler<MinPolicy>>{}(
+          args);
+    }
+
+    std::array<Lane, kNLanes> lanes;
+    std::array<std::vector<KMer::value_type>, kNLanes> tiles;
+    Reg<kNLanes> values;
+
+    for (std::int64_t i = 0; i < kNLanes; ++i) {
+      auto& lane = lanes[i];
+      lane.first_window = n_windows * i / kNLanes;
+      lane.next_window = lane.first_window;
+      lane.end_window = n_windows * (i + 1) / kNLanes;
+      lane.end_kmer = lane.end_window + args.window_length - 1;
+      lane.tile_pos = lane.first_window;
+      lane.tile_fill = 1;
+      lane.next_kmer = lane.first_window + 1;
+      lane.min_pos = lane.first_window;
+      lane.dst.reserve(
+          reserve_minimizers(lane.end_window - lane.first_window,
+                             args.window_length));
+
+      values[i] = 0;
+      for (std::int64_t j = 0; j < args.kmer_length; ++j) {
+        values[i] ^= srol(kNtHashSeeds[args.seq.Code(lane.first_window + j)],
+                          args.kmer_length - (j + 1));
+      }
+
+      tiles[i].resize(args.window_length - 1 + kTileSize);
+      tiles[i][0] = values[i];
+    }
+
+    auto capacity = static_cast<std::int64_t>(tiles.front().size());
+    auto room = [capacity](Lane const& lane) {
+      return std::min(capacity - lane.tile_fill,
+                      lane.end_kmer - lane.next_kmer);
+    };
+
+    while (std::ranges::any_of(lanes, [](Lane const& lane) {
+      return lane.next_window < lane.end_window;
+    })) {
+      auto n_steps = std::ranges::min(lanes | std::views::transform(room));
+      for (std::int64_t step = 0; step < n_steps; ++step) {
+        Reg<kNLanes> base_out, base_in;
+        for (std::int64_t i = 0; i < kNLanes; ++i) {
+          base_out[i] = args.seq.Code(lanes[i].next_kmer - 1);
+          base_in[i] =
+              args.seq.Code(lanes[i].next_kmer + args.kmer_length - 1);
+        }
+
+        values =
+            nthash_bulk<kNLanes>(values, base_out, base_in, args.kmer_length);
+        for (std::int64_t i = 0; i < kNLanes; ++i) {
+          tiles[i][lanes[i].tile_fill++] = values[i];
+          ++lanes[i].next_kmer;
+        }
+      }
+
+      // lanes differ in length by at most one kmer
+      for (std::int64_t i = 0; i < kNLanes; ++i) {
+        auto& lane = lanes[i];
+        for (auto n = room(lane); n > 0; --n) {
+          values[i] =
+              nthash(values[i], args.seq.Code(lane.next_kmer - 1),
+                     args.seq.Code(lane.next_kmer + args.kmer_length - 1),
+                     args.kmer_length);
+          tiles[i][lane.tile_fill++] = values[i];
+          ++lane.next_kmer;
+        }
+
+        sample<T>(args, lanes[i], tiles[i]);
+      }
+    }
+
+    // stitch lanes onto the first one, dropping minimizers shared across lane
+    // borders
+    std::size_t n_dst = 0;
+    for (auto const& lane : lanes) {
+      n_dst += lane.dst.size();
+    }
+    std::vector<KMer> dst = std::move(lanes.front().dst);
+    dst.reserve(n_dst);
+    for (auto const& lane : lanes | std::views::drop(1)) {
+      std::size_t j = 0;
+      if constexpr (T::kSticky) {
+        j = repair<T>(args, lane, dst);
+      }
+      for (; j < lane.dst.size(); ++j) {
+        if (dst.back().position() != lane.dst[j].position()) {
+          dst.push_back(lane.dst[j]);
+        }
+      }
+    }
+
     return dst;
   }
 
  public:
-  std::vector<KMer> operator()(MinimizeArgs args,
-                               std::vector<KMer::value_type> hashes) const {
-    return impl(args, hashes);
+  std::vector<KMer> operator()(MinimizeArgs args) const {
+    return with_ties(args.tie_policy,
+                     [&]<class T>(T) { return impl<T>(args); });
+  }
+};
+
+// Samples windows of `window_length` kmers using only the minimizers of a finer
+// window length. The minimum of a coarse window is the minimum of every finer
+// window inside it, so it is always among the finer minimizers and the output
+// is a subset of them. Between windows where a finer minimizer enters or the
+// current one leaves nothing changes, so the scan jumps from event to event.
+class CascadeSampler {
+  template <class T>
+  std::size_t impl(T ties, MinimizeArgs args, std::int64_t n_kmers,
+                   std::span<KMer const> minimizers,
+                   std::span<KMer> dst) const {
+    std::int64_t const w = args.window_length;
+    std::int64_t const n_windows = n_kmers - w + 1;
+
+    // monotone queue of indices into minimizers
+    ArenaVector<std::int64_t> queue(minimizers.size(),
+                                    ArenaAllocator<std::int64_t>(args.arena));
+    std::int64_t head = 0, tail = 0;
+
+    std::int64_t idx = 0;
+    std::size_t next = 0;
+    for (std::int64_t i = 0; i < n_windows;) {
+      for (; next < minimizers.size() &&
+             minimizers[next].position() < i + w;
+           ++next) {
+        while (tail > head && T::scan(minimizers[next].value(),
+                                      minimizers[queue[tail - 1]].value())) {
+          --tail;
+        }
+        queue[tail++] = next;
+      }
+      while (minimizers[queue[head]].position() < i) {
+        ++head;
+      }
+
+      auto min = minimizers[queue[head]];
+      if (idx > 0 && keeps_previous(ties, dst[idx - 1], i, min.value())) {
+        min = dst[idx - 1];
+      }
+      if (idx == 0 || dst[idx - 1].position() != min.position()) {
+        dst[idx++] = min;
+      }
+
+      auto event = n_windows;
+      if (next < minimizers.size()) {
+        event = std::min<std::int64_t>(event,
+                                       minimizers[next].position() - w + 1);
+      }
+      event = std::min<std::int64_t>(
+          event, minimizers[queue[head]].position() + 1);
+      if constexpr (T::kSticky) {
+        event = std::min<std::int64_t>(event, dst[idx - 1].position() + 1);
+      }
+      i = std::max(i + 1, event);
+    }
+
+    return idx;
+  }
+
+ public:
+  std::size_t operator()(MinimizeArgs args, std::int64_t n_kmers,
+                         std::span<KMer const> minimizers,
+                         std::span<KMer> dst) const {
+    return with_ties(args.tie_policy, [&](auto ties) {
+      return impl(ties, args, n_kmers, minimizers, dst);
+    });
+  }
+};
+
+// Hashes once and samples the finest window length with Sampler; every
+// coarser level is cascaded from the level before it.
+template <class Hasher, class Sampler>
+class LevelsMixinBase {
+  [[no_unique_address]] Hasher hasher_;
+  [[no_unique_address]] Sampler sampler_;
+  [[no_unique_address]] CascadeSampler cascade_;
+
+ public:
+  std::vector<std::vector<KMer>> operator()(MinimizeLevelsArgs args) const {
+    // every coarser window must contain a finer one for the cascade to hold
+    if (!std::ranges::is_sorted(args.window_lengths)) {
+      throw std::invalid_argument("window lengths must be ascending");
+    }
+
+    std::vector<std::vector<KMer>> dst(args.window_lengths.size());
+    if (dst.empty()) {
+      return dst;
+    }
+
+    auto level_args = MinimizeArgs{
+        .seq = args.seq,
+        .window_length = args.window_lengths.front(),
+        .kmer_length = args.kmer_length,
+        .tie_policy = args.tie_policy,
+        .arena = args.arena,
+    };
+    if (args.seq.size() < level_args.window_length + args.kmer_length - 1) {
+      return dst;
+    }
+
+    auto hashes =
+        hasher_(level_args, ArenaAllocator<KMer::value_type>(args.arena));
+    dst[0] = sample_into(args.arena, hashes.size(), [&](std::span<KMer> level) {
+      return sampler_(level_args, hashes, level);
+    });
+
+    std::int64_t n_kmers = hashes.size();
+    for (std::size_t i = 1; i < dst.size(); ++i) {
+      level_args.window_length = args.window_lengths[i];
+      if (n_kmers < level_args.window_length) {
+        break;
+      }
+
+      dst[i] = sample_into(
+          args.arena, dst[i - 1].size(), [&](std::span<KMer> level) {
+            return cascade_(level_args, n_kmers, dst[i - 1], level);
+          });
+    }
+
+    return dst;
+  }
+};
+
+// Turns a stream of minimizer chunks into k-min-mers. The last
+// kminmer_length - 1 minimizers of a chunk are carried into the next one. Each
+// k-min-mer hash is a xor of its mixed minimizer hashes rotated by their
+// offset, accumulated one offset at a time over the whole chunk so the passes
+// vectorize. Mixing first keeps the xor from cancelling structured inputs such
+// as masked hashes that differ by a shift.
+class KMinMerProjection {
+  std::int32_t kmer_length_;
+  std::int32_t kminmer_length_;
+  std::vector<KMer::value_type> values_;
+  std::vector<KMer::position_type> positions_;
+  std::vector<KMer::value_type> acc_;
+
+ public:
+  explicit KMinMerProjection(MinimizeKMinMersArgs args)
+      : kmer_length_(args.kmer_length), kminmer_length_(args.kminmer_length) {}
+
+  void operator()(std::span<KMer const> minimizers, std::vector<KMinMer>& dst) {
+    auto const n_carried = values_.size();
+    for (auto const& kmer : minimizers) {
+      values_.push_back(kmer.value());
+      positions_.push_back(kmer.position());
+    }
+
+    auto mixed = std::span(values_).subspan(n_carried);
+    for (std::size_t i = 0; i < mixed.size(); ++i) {
+      mixed[i] = hash(mixed[i], ~0ull);
+    }
+
+    std::int64_t const n = std::ssize(values_) - kminmer_length_ + 1;
+    if (n <= 0) {
+      return;
+    }
+
+    acc_.assign(n, 0);
+    auto acc = std::span(acc_);
+    for (std::int32_t j = 0; j < kminmer_length_; ++j) {
+      auto const shift = kminmer_length_ - 1 - j;
+      auto const values = std::span(values_).subspan(j, n);
+      for (std::int64_t i = 0; i < n; ++i) {
+        acc[i] ^= std::rotl(values[i], shift);
+      }
+    }
+
+    for (std::int64_t i = 0; i < n; ++i) {
+      dst.emplace_back(acc[i], positions_[i],
+                       positions_[i + kminmer_length_ - 1] + kmer_length_);
+    }
+
+    values_.erase(values_.begin(), values_.begin() + n);
+    positions_.erase(positions_.begin(), positions_.begin() + n);
+  }
+};
+
+// Samples chunks of windows small enough for their minimizers to stay in cache
+// and projects each chunk into k-min-mers right away. Without sticky ties a
+// window's minimizer depends on that window alone, so chunks only have to drop
+// the minimizer shared with the previous chunk. Sticky ties depend on the
+// previous window and are sampled as a single chunk.
+template <class Hasher, class Sampler>
+class KMinMersMixinBase {
+  static constexpr std::int64_t kChunkSize = 1024;
+
+  [[no_unique_address]] Hasher hasher_;
+  [[no_unique_address]] Sampler sampler_;
+
+ public:
+  std::vector<KMinMer> operator()(MinimizeKMinMersArgs args) const {
+    // an empty k-min-mer would end before its first minimizer
+    if (args.kminmer_length < 1) {
+      throw std::invalid_argument("k-min-mer length must be positive");
+    }
+
+    auto seq_args = MinimizeArgs{
+        .seq = args.seq,
+        .window_length = args.window_length,
+        .kmer_length = args.kmer_length,
+        .tie_policy = args.tie_policy,
+        .arena = args.arena,
+    };
+    if (args.seq.size() < args.window_length + args.kmer_length - 1) {
+      return {};
+    }
+
+    auto hashes =
+        hasher_(seq_args, ArenaAllocator<KMer::value_type>(args.arena));
+    std::int64_t const n_windows = hashes.size() - args.window_length + 1;
+    auto const chunk_size = with_ties(args.tie_policy, [&]<class T>(T) {
+      return T::kSticky ? n_windows : std::min(n_windows, kChunkSize);
+    });
+
+    ArenaVector<KMer> minimizers(chunk_size + args.window_length - 1,
+                                 ArenaAllocator<KMer>(args.arena));
+    KMinMerProjection projection(args);
+    std::vector<KMinMer> dst;
+    dst.reserve(reserve_minimizers(hashes.size(), args.window_length));
+
+    std::int64_t last = -1;
+    for (std::int64_t first = 0; first < n_windows; first += chunk_size) {
+      auto n = std::min(chunk_size, n_windows - first);
+      auto n_dst = sampler_(
+          seq_args,
+          std::span(hashes).subspan(first, n + args.window_length - 1),
+          minimizers);
+
+      std::size_t n_new = 0;
+      for (std::size_t i = 0; i < n_dst; ++i) {
+        std::int64_t pos = minimizers[i].position() + first;
+        if (pos > last) {
+          minimizers[n_new++] =
+              KMer(minimizers[i].value(), pos, minimizers[i].strand());
+          last = pos;
+        }
+      }
+
+      projection(std::span(minimizers).first(n_new), dst);
+    }
+
+    return dst;
   }
 };
 
@@ -478,44 +1130,118 @@ using NtHashArgMinUnrolledRecoveryMixin =
 // SplitWindow mixins
 using SplitWindowMixin = ArgMinMixinBase<ThomasWangHasher, SplitWindow>;
 
+// Multi record mixins
+using ArgMinUnrolledRecoveryRecordsMixin =
+    RecordsMixinBase<ThomasWangHasher, UnrolledArgMinRecoverySampler>;
+using NtHashArgMinUnrolledRecoveryRecordsMixin =
+    RecordsMixinBase<NtHasherOpt, UnrolledArgMinRecoverySampler>;
+
+// Multi level mixins
+using ArgMinRecoveryLevelsMixin =
+    LevelsMixinBase<ThomasWangHasher, PredicationArgMinRecoverySampler>;
+using NtHashArgMinRecoveryLevelsMixin =
+    LevelsMixinBase<NtHasherOpt, PredicationArgMinRecoverySampler>;
+
+// Minimizer space mixins
+using ArgMinUnrolledRecoveryKMinMersMixin =
+    KMinMersMixinBase<ThomasWangHasher, UnrolledArgMinRecoverySampler>;
+using NtHashArgMinUnrolledRecoveryKMinMersMixin =
+    KMinMersMixinBase<NtHasherOpt, UnrolledArgMinRecoverySampler>;
+
+// Blocked NtHash mixins
+using NtHashBlockedRecoveryMixin =
+    BlockedNtHashMixinBase<PredicationMinElement>;
+
 }  // namespace
 
 std::vector<KMer::value_type> NtHash(MinimizeArgs args) {
+  MemoryStatsScope scope(args.stats);
   return NtHasher{}(args);
 }
 
 std::vector<KMer::value_type> NtHashOpt(MinimizeArgs args) {
+  MemoryStatsScope scope(args.stats);
   return NtHasherOpt{}(args);
 }
 
 // Arg min based implementations
 std::vector<KMer> ArgMinMinimize(MinimizeArgs args) {
+  MemoryStatsScope scope(args.stats);
   return ArgMinMixin{}(args);
 }
 
 std::vector<KMer> ArgMinUnrolledMinimize(MinimizeArgs args) {
+  MemoryStatsScope scope(args.stats);
   return ArgMinUnrolledMixin{}(args);
 }
 
 std::vector<KMer> NtHashArgMinUnrolledMinimize(MinimizeArgs args) {
+  MemoryStatsScope scope(args.stats);
   return NtHashArgMinUnrolledMixin{}(args);
 }
 
 // Arg min recovery based implementations
 std::vector<KMer> ArgMinRecoveryMinimize(MinimizeArgs args) {
+  MemoryStatsScope scope(args.stats);
   return ArgMinRecoveryMixin{}(args);
 }
 
 std::vector<KMer> ArgMinRecoveryUnrolledMinimize(MinimizeArgs args) {
+  MemoryStatsScope scope(args.stats);
   return ArgMinUnrolledRecoveryMixin{}(args);
 }
 
 std::vector<KMer> NtHashRecoveryUnrolledMinimize(MinimizeArgs args) {
+  MemoryStatsScope scope(args.stats);
   return NtHashArgMinUnrolledRecoveryMixin{}(args);
 }
 
 std::vector<KMer> SplitWindowMinimize(MinimizeArgs args) {
+  MemoryStatsScope scope(args.stats);
   return SplitWindowMixin{}(args);
 }
 
+std::vector<KMer> NtHashBlockedRecoveryMinimize(MinimizeArgs args) {
+  MemoryStatsScope scope(args.stats);
+  return NtHashBlockedRecoveryMixin{}(args);
+}
+
+// Multi record implementations
+std::vector<RecordKMer> ArgMinRecoveryUnrolledMinimizeRecords(
+    MinimizeRecordsArgs args) {
+  MemoryStatsScope scope(args.stats);
+  return ArgMinUnrolledRecoveryRecordsMixin{}(args);
+}
+
+std::vector<RecordKMer> NtHashRecoveryUnrolledMinimizeRecords(
+    MinimizeRecordsArgs args) {
+  MemoryStatsScope scope(args.stats);
+  return NtHashArgMinUnrolledRecoveryRecordsMixin{}(args);
+}
+
+// Multi level implementations
+std::vector<std::vector<KMer>> ArgMinRecoveryMinimizeLevels(
+    MinimizeLevelsArgs args) {
+  MemoryStatsScope scope(args.stats);
+  return ArgMinRecoveryLevelsMixin{}(args);
+}
+
+std::vector<std::vector<KMer>> NtHashRecoveryMinimizeLevels(
+    MinimizeLevelsArgs args) {
+  MemoryStatsScope scope(args.stats);
+  return NtHashArgMinRecoveryLevelsMixin{}(args);
+}
+
+std::vector<KMinMer> ArgMinRecoveryUnrolledMinimizeKMinMers(
+    MinimizeKMinMersArgs args) {
+  MemoryStatsScope scope(args.stats);
+  return ArgMinUnrolledRecoveryKMinMersMixin{}(args);
+}
+
+std::vector<KMinMer> NtHashRecoveryUnrolledMinimizeKMinMers(
+    MinimizeKMinMersArgs args) {
+  MemoryStatsScope scope(args.stats);
+  return NtHashArgMinUnrolledRecoveryKMinMersMixin{}(args);
+}
+
 }  // namespace tb
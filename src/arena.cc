@@ -0,0 +1,146 @@
+#include "tb/arena.hpp"
+
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <climits>
+#include <new>
+#include <utility>
+
+namespace tb {
+
+namespace {
+
+// numaif.h lives in libnuma; the syscall needs only the policy value
+constexpr int kMpolPreferred = 1;
+
+int CurrentNode() noexcept {
+  unsigned cpu = 0, node = 0;
+  if (getcpu(&cpu, &node) != 0) {
+    return 0;
+  }
+
+  return static_cast<int>(node);
+}
+
+void* MapAnonymous(std::size_t size, int flags) noexcept {
+  auto ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANONYMOUS | flags, -1, 0);
+  return ptr == MAP_FAILED ? nullptr : ptr;
+}
+
+}  // namespace
+
+Arena::Arena(ArenaOptions options) : options_(options) {}
+
+Arena::~Arena() {
+  Release();
+  for (auto const& block : live_) {
+    munmap(block.ptr, block.size);
+  }
+}
+
+Arena::Block Arena::Map(std::size_t size, int node) const {
+  void* ptr = nullptr;
+  if (options_.huge_pages == HugePages::kExplicit) {
+    ptr = MapAnonymous(size, MAP_HUGETLB);
+  }
+
+  if (!ptr) {
+    // over map so the block can start on a huge page boundary
+    auto raw = static_cast<char*>(MapAnonymous(size + kHugePageSize, 0));
+    if (!raw) {
+      throw std::bad_alloc();
+    }
+
+    auto begin = reinterpret_cast<char*>(
+        (reinterpret_cast<std::uintptr_t>(raw) + kHugePageSize - 1) &
+        ~(kHugePageSize - 1));
+    if (begin != raw) {
+      munmap(raw, begin - raw);
+    }
+    munmap(begin + size, raw + kHugePageSize - begin);
+
+    ptr = begin;
+    if (options_.huge_pages != HugePages::kNone) {
+      madvise(ptr, size, MADV_HUGEPAGE);
+    }
+  }
+
+  // best effort; pages are placed on first touch until the policy applies
+  if (options_.numa_local && node < int(sizeof(unsigned long) * CHAR_BIT)) {
+    unsigned long mask = 1ul << node;
+    syscall(SYS_mbind, ptr, size, kMpolPreferred, &mask,
+            sizeof(mask) * CHAR_BIT, 0);
+  }
+
+  return {.ptr = ptr, .size = size, .node = node};
+}
+
+void* Arena::Allocate(std::size_t n_bytes) {
+  if (n_bytes < kMinBlockSize) {
+    return ::operator new(n_bytes);
+  }
+
+  auto const size = (n_bytes + kHugePageSize - 1) & ~(kHugePageSize - 1);
+  auto const node = options_.numa_local ? CurrentNode() : 0;
+
+  std::lock_guard lock(mutex_);
+  auto best = free_.end();
+  for (auto it = free_.begin(); it != free_.end(); ++it) {
+    if (it->size < size) {
+      continue;
+    }
+
+    if (best == free_.end() ||
+        std::pair(it->node != node, it->size) <
+            std::pair(best->node != node, best->size)) {
+      best = it;
+    }
+  }
+
+  if (best != free_.end()) {
+    live_.push_back(*best);
+    *best = free_.back();
+    free_.pop_back();
+  } else {
+    live_.push_back(Map(size, node));
+    mapped_bytes_ += size;
+  }
+
+  // Deallocate must not allocate
+  free_.reserve(live_.size() + free_.size());
+
+  return live_.back().ptr;
+}
+
+void Arena::Deallocate(void* ptr, std::size_t n_bytes) noexcept {
+  if (n_bytes < kMinBlockSize) {
+    return ::operator delete(ptr);
+  }
+
+  std::lock_guard lock(mutex_);
+  auto it = std::ranges::find(live_, ptr, &Block::ptr);
+  free_.push_back(*it);
+  *it = live_.back();
+  live_.pop_back();
+}
+
+void Arena::Release() noexcept {
+  std::lock_guard lock(mutex_);
+  for (auto const& block : free_) {
+    munmap(block.ptr, block.size);
+    mapped_bytes_ -= block.size;
+  }
+  free_.clear();
+}
+
+std::size_t Arena::mapped_bytes() const {
+  std::lock_guard lock(mutex_);
+  return mapped_bytes_;
+}
+
+}  // namespace tb
@@ -1,6 +1,10 @@
 #include <benchmark/benchmark.h>
 
+#include <array>
+#include <random>
+
 #include "tb/algo.hpp"
+#include "tb/index.hpp"
 
 namespace {
 
@@ -8,24 +12,169 @@ constexpr int kSeed = 42;
 constexpr std::size_t kNBasesSmall = 1'000uz;
 constexpr std::size_t kNBasesLarge = 1'000'000uz;
 
-template <auto MinimizeFn>
+constexpr std::array kProfiles = {
+    tb::kUniformProfile,
+    tb::kHumanLikeProfile,
+};
+
+void SetMemoryCounters(benchmark::State& state, tb::MemoryStats const& stats,
+                       std::size_t n_bases) {
+  state.counters["allocs"] = stats.n_allocations;
+  state.counters["peak_heap"] =
+      benchmark::Counter(stats.peak_bytes, benchmark::Counter::kDefaults,
+                         benchmark::Counter::kIs1024);
+  state.counters["heap_per_bp"] =
+      static_cast<double>(stats.peak_bytes) / n_bases;
+  state.counters["peak_rss"] =
+      benchmark::Counter(stats.peak_rss_bytes, benchmark::Counter::kDefaults,
+                         benchmark::Counter::kIs1024);
+}
+
+template <auto MinimizeFn, bool kUseArena = false>
 void BM_Minimize(benchmark::State& state) {
+  tb::Arena arena;
+  tb::MemoryStats stats;
+  tb::ResetPeakRss();
   for (auto _ : state) {
     state.PauseTiming();
-    tb::MockSequence seq(state.range(0), kSeed);
+    tb::MockSequence seq(state.range(0), kSeed, kProfiles[state.range(1)]);
     state.ResumeTiming();
 
     auto kmers = MinimizeFn({
         .seq = seq,
         .window_length = 11,
         .kmer_length = 21,
+        .stats = &stats,
+        .arena = kUseArena ? &arena : nullptr,
     });
 
     benchmark::DoNotOptimize(kmers.data());
   }
+
+  SetMemoryCounters(state, stats, state.range(0));
+  state.counters["arena_mapped"] =
+      benchmark::Counter(arena.mapped_bytes(), benchmark::Counter::kDefaults,
+                         benchmark::Counter::kIs1024);
+}
+
+template <auto MinimizeFn>
+void BM_MinimizeRecords(benchmark::State& state) {
+  tb::MemoryStats stats;
+  tb::ResetPeakRss();
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::vector<std::size_t> record_lengths(state.range(0) / state.range(1),
+                                            state.range(1));
+    tb::MockSequenceSet records(record_lengths, kSeed);
+    state.ResumeTiming();
+
+    auto kmers = MinimizeFn({
+        .records = records,
+        .window_length = 11,
+        .kmer_length = 21,
+        .stats = &stats,
+    });
+
+    benchmark::DoNotOptimize(kmers.data());
+  }
+
+  SetMemoryCounters(state, stats, state.range(0));
+}
+
+template <auto MinimizeFn>
+void BM_MinimizeLevels(benchmark::State& state) {
+  static constexpr std::array<std::int32_t, 3> kWindowLengths = {11, 50, 200};
+
+  tb::MemoryStats stats;
+  tb::ResetPeakRss();
+  for (auto _ : state) {
+    state.PauseTiming();
+    tb::MockSequence seq(state.range(0), kSeed, kProfiles[state.range(1)]);
+    state.ResumeTiming();
+
+    auto levels = MinimizeFn({
+        .seq = seq,
+        .window_lengths = kWindowLengths,
+        .kmer_length = 21,
+        .stats = &stats,
+    });
+
+    benchmark::DoNotOptimize(levels.data());
+  }
+
+  SetMemoryCounters(state, stats, state.range(0));
+}
+
+template <auto MinimizeFn>
+void BM_MinimizeKMinMers(benchmark::State& state) {
+  tb::MemoryStats stats;
+  tb::ResetPeakRss();
+  for (auto _ : state) {
+    state.PauseTiming();
+    tb::MockSequence seq(state.range(0), kSeed, kProfiles[state.range(1)]);
+    state.ResumeTiming();
+
+    auto kminmers = MinimizeFn({
+        .seq = seq,
+        .window_length = 11,
+        .kmer_length = 21,
+        .kminmer_length = 4,
+        .stats = &stats,
+    });
+
+    benchmark::DoNotOptimize(kminmers.data());
+  }
+
+  SetMemoryCounters(state, stats, state.range(0));
 }
 
-std::vector<std::vector<std::int64_t>> kArgList = {{kNBasesLarge}};
+// Queries reads sampled from a reference against its minimizer index
+void BM_Query(benchmark::State& state) {
+  constexpr std::size_t kNReads = 1'000uz;
+  constexpr std::size_t kReadLength = 10'000uz;
+
+  std::vector<std::size_t> record_lengths(state.range(0) / kNBasesLarge,
+                                          kNBasesLarge);
+  tb::MockSequenceSet reference(record_lengths, kSeed);
+  tb::MinimizerIndex index(tb::NtHashRecoveryUnrolledMinimizeRecords({
+      .records = reference,
+      .window_length = 11,
+      .kmer_length = 21,
+  }));
+
+  std::mt19937_64 rng_engine(kSeed);
+  std::uniform_int_distribution<std::size_t> offset_distr(
+      0, reference.sequence().size() - kReadLength);
+  std::vector<std::vector<tb::KMer>> reads(kNReads);
+  for (auto& read_minimizers : reads) {
+    tb::MockSequence read;
+    for (auto i = offset_distr(rng_engine), n = i + kReadLength; i < n; ++i) {
+      read.push_back(reference.sequence().Code(i));
+    }
+    read_minimizers = tb::NtHashRecoveryUnrolledMinimize({
+        .seq = read,
+        .window_length = 11,
+        .kmer_length = 21,
+    });
+  }
+
+  std::size_t n_anchors = 0;
+  for (auto _ : state) {
+    for (auto const& read_minimizers : reads) {
+      auto anchors = index.Query(read_minimizers);
+      n_anchors += anchors.size();
+      benchmark::DoNotOptimize(anchors.data());
+    }
+  }
+
+  state.counters["anchors_per_read"] =
+      static_cast<double>(n_anchors) / (state.iterations() * kNReads);
+  state.SetItemsProcessed(state.iterations() * kNReads);
+}
+
+std::vector<std::vector<std::int64_t>> kArgList = {{kNBasesLarge}, {0, 1}};
+std::vector<std::vector<std::int64_t>> kRecordsArgList = {{kNBasesLarge},
+                                                          {kNBasesSmall}};
 
 // Reference
 BENCHMARK_TEMPLATE(BM_Minimize, tb::NaiveMinimize)->ArgsProduct(kArgList);
@@ -51,6 +200,41 @@ BENCHMARK_TEMPLATE(BM_Minimize, tb::NtHashRecoveryUnrolledMinimize)
 // Split window
 BENCHMARK_TEMPLATE(BM_Minimize, tb::SplitWindowMinimize)->ArgsProduct(kArgList);
 
+// Cache blocked
+BENCHMARK_TEMPLATE(BM_Minimize, tb::NtHashBlockedRecoveryMinimize)
+    ->ArgsProduct(kArgList);
+
+// Multi record
+BENCHMARK_TEMPLATE(BM_MinimizeRecords,
+                   tb::ArgMinRecoveryUnrolledMinimizeRecords)
+    ->ArgsProduct(kRecordsArgList);
+BENCHMARK_TEMPLATE(BM_MinimizeRecords,
+                   tb::NtHashRecoveryUnrolledMinimizeRecords)
+    ->ArgsProduct(kRecordsArgList);
+
+// Huge page arena reused across iterations
+BENCHMARK_TEMPLATE(BM_Minimize, tb::NtHashRecoveryUnrolledMinimize, true)
+    ->ArgsProduct(kArgList);
+BENCHMARK_TEMPLATE(BM_Minimize, tb::NtHashBlockedRecoveryMinimize, true)
+    ->ArgsProduct(kArgList);
+
+// Nested levels
+BENCHMARK_TEMPLATE(BM_MinimizeLevels, tb::ArgMinRecoveryMinimizeLevels)
+    ->ArgsProduct(kArgList);
+BENCHMARK_TEMPLATE(BM_MinimizeLevels, tb::NtHashRecoveryMinimizeLevels)
+    ->ArgsProduct(kArgList);
+
+// Minimizer space
+BENCHMARK_TEMPLATE(BM_MinimizeKMinMers,
+                   tb::ArgMinRecoveryUnrolledMinimizeKMinMers)
+    ->ArgsProduct(kArgList);
+BENCHMARK_TEMPLATE(BM_MinimizeKMinMers,
+                   tb::NtHashRecoveryUnrolledMinimizeKMinMers)
+    ->ArgsProduct(kArgList);
+
+// Seed lookup
+BENCHMARK(BM_Query)->Arg(kNBasesLarge)->Arg(10 * kNBasesLarge);
+
 // NthHash
 BENCHMARK_TEMPLATE(BM_Minimize, tb::NtHash)->ArgsProduct(kArgList);
 BENCHMARK_TEMPLATE(BM_Minimize, tb::NtHashOpt)->ArgsProduct(kArgList);
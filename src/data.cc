@@ -1,6 +1,8 @@
 #include "tb/data.hpp"
 
 #include <algorithm>
+#include <execution>
+#include <numeric>
 #include <random>
 #include <array>
 
@@ -10,11 +12,143 @@ namespace {
 
 constexpr std::size_t kBasesPerBlock = 32uz;
 
+// Generation chunks start on a block boundary so they never share a word
+constexpr std::size_t kBasesPerChunk = 1uz << 20uz;
+
+constexpr std::size_t kBackgroundLength = 1000uz;
+
+enum Segment : std::size_t {
+  kBackground,
+  kTandemRepeat,
+  kInterspersedRepeat,
+  kLowComplexity,
+  kNBlock,
+};
+
+class ChunkGenerator {
+  MockSequenceProfile const &profile_;
+  std::vector<std::vector<std::uint8_t>> const &families_;
+  std::span<std::uint64_t> data_;
+  std::size_t n_bases_;
+  std::size_t pos_ = 0;
+  std::mt19937_64 rng_engine_;
+
+  bool full() const noexcept { return pos_ == n_bases_; }
+
+  void put(std::uint64_t code) {
+    data_[pos_ >> 5] |= code << ((pos_ << 1) & 63);
+    ++pos_;
+  }
+
+  std::size_t draw_length(std::size_t mean) {
+    return std::uniform_int_distribution<std::size_t>(1, 2 * mean - 1)(
+        rng_engine_);
+  }
+
+  std::uint8_t draw_base() {
+    auto is_gc = std::bernoulli_distribution(profile_.gc_content)(rng_engine_);
+    std::uint8_t base = std::bernoulli_distribution(0.5)(rng_engine_);
+    // A, T or C, G
+    return is_gc ? base + 1 : base * 3;
+  }
+
+  std::uint8_t mutate(std::uint8_t code) {
+    return std::bernoulli_distribution(profile_.repeat_divergence)(rng_engine_)
+               ? draw_base()
+               : code;
+  }
+
+  void background() {
+    for (auto n = draw_length(kBackgroundLength); n > 0 && !full(); --n) {
+      put(draw_base());
+    }
+  }
+
+  void tandem_repeat() {
+    std::vector<std::uint8_t> unit(std::uniform_int_distribution<std::size_t>(
+        1, profile_.max_tandem_unit_length)(rng_engine_));
+    std::ranges::generate(unit, [this] { return draw_base(); });
+    for (std::size_t i = 0, n = draw_length(profile_.tandem_repeat_length);
+         i < n && !full(); ++i) {
+      put(mutate(unit[i % unit.size()]));
+    }
+  }
+
+  void interspersed_repeat() {
+    auto const &family = families_[std::uniform_int_distribution<std::size_t>(
+        0, families_.size() - 1)(rng_engine_)];
+    auto reverse = std::bernoulli_distribution(0.5)(rng_engine_);
+    for (std::size_t i = 0; i < family.size() && !full(); ++i) {
+      put(mutate(reverse ? family[family.size() - i - 1] ^ 3 : family[i]));
+    }
+  }
+
+  void low_complexity() {
+    std::array<std::uint8_t, 2> unit = {draw_base(), draw_base()};
+    unit[1] = std::bernoulli_distribution(0.5)(rng_engine_) ? unit[0] : unit[1];
+    for (std::size_t i = 0, n = draw_length(profile_.low_complexity_length);
+         i < n && !full(); ++i) {
+      put(unit[i & 1]);
+    }
+  }
+
+  void n_block() {
+    for (auto n = profile_.n_block_length; n > 0 && !full(); --n) {
+      put(0);
+    }
+  }
+
+ public:
+  ChunkGenerator(MockSequenceProfile const &profile,
+                 std::vector<std::vector<std::uint8_t>> const &families,
+                 std::span<std::uint64_t> data, std::size_t n_bases,
+                 std::seed_seq &seed)
+      : profile_(profile), families_(families), data_(data),
+        n_bases_(n_bases), rng_engine_(seed) {}
+
+  void operator()() {
+    // segments are drawn proportionally to rate / mean length so that each
+    // kind covers its rate of bases
+    auto repeat_rate = profile_.tandem_repeat_rate +
+                       profile_.interspersed_repeat_rate +
+                       profile_.low_complexity_rate + profile_.n_block_rate;
+    std::discrete_distribution<std::size_t> segment_distr({
+        std::max(1.0 - repeat_rate, 0.0) / kBackgroundLength,
+        profile_.tandem_repeat_rate / profile_.tandem_repeat_length,
+        families_.empty() ? 0.0
+                          : profile_.interspersed_repeat_rate /
+                                profile_.repeat_family_length,
+        profile_.low_complexity_rate / profile_.low_complexity_length,
+        profile_.n_block_rate / profile_.n_block_length,
+    });
+
+    while (!full()) {
+      switch (segment_distr(rng_engine_)) {
+        case kBackground:
+          background();
+          break;
+        case kTandemRepeat:
+          tandem_repeat();
+          break;
+        case kInterspersedRepeat:
+          interspersed_repeat();
+          break;
+        case kLowComplexity:
+          low_complexity();
+          break;
+        case kNBlock:
+          n_block();
+          break;
+      }
+    }
+  }
+};
+
 } // namespace
 
 MockSequence::MockSequence(std::size_t n_bases, int seed)
     : n_bases_(n_bases),
-      data_(n_bases / kBasesPerBlock + (n_bases < kBasesPerBlock)) {
+      data_((n_bases + kBasesPerBlock - 1) / kBasesPerBlock) {
   std::mt19937_64 rng_engine(seed);
   auto n_blocks = n_bases / kBasesPerBlock;
   std::uniform_int_distribution<std::uint64_t> distr;
@@ -22,4 +156,54 @@ MockSequence::MockSequence(std::size_t n_bases, int seed)
                         [&] -> std::uint64_t { return distr(rng_engine); });
 };
 
+MockSequence::MockSequence(std::size_t n_bases, int seed,
+                           MockSequenceProfile const &profile)
+    : n_bases_(n_bases),
+      data_((n_bases + kBasesPerBlock - 1) / kBasesPerBlock) {
+  std::mt19937_64 rng_engine(seed);
+  std::vector<std::vector<std::uint8_t>> families(
+      profile.n_repeat_families,
+      std::vector<std::uint8_t>(profile.repeat_family_length));
+  std::uniform_int_distribution<int> base_distr(0, 3);
+  for (auto &family : families) {
+    std::ranges::generate(family, [&] { return base_distr(rng_engine); });
+  }
+
+  auto n_chunks = (n_bases + kBasesPerChunk - 1) / kBasesPerChunk;
+  std::vector<std::size_t> chunks(n_chunks);
+  std::iota(chunks.begin(), chunks.end(), 0uz);
+  std::for_each(std::execution::par, chunks.begin(), chunks.end(),
+                [&](std::size_t chunk) {
+                  auto begin = chunk * kBasesPerChunk;
+                  auto n_chunk_bases =
+                      std::min(kBasesPerChunk, n_bases - begin);
+                  std::seed_seq chunk_seed{seed, static_cast<int>(chunk)};
+                  ChunkGenerator(profile, families,
+                                 std::span(data_).subspan(
+                                     begin / kBasesPerBlock,
+                                     (n_chunk_bases + kBasesPerBlock - 1) /
+                                         kBasesPerBlock),
+                                 n_chunk_bases, chunk_seed)();
+                });
+}
+
+MockSequenceSet::MockSequenceSet(std::span<MockSequence const> records)
+    : offsets_{0} {
+  for (auto const &record : records) {
+    for (std::size_t i = 0; i < record.size(); ++i) {
+      seq_.push_back(record.Code(i));
+    }
+    offsets_.push_back(seq_.size());
+  }
+}
+
+MockSequenceSet::MockSequenceSet(std::span<std::size_t const> record_lengths,
+                                 int seed)
+    : seq_(std::reduce(record_lengths.begin(), record_lengths.end()), seed),
+      offsets_{0} {
+  for (auto length : record_lengths) {
+    offsets_.push_back(offsets_.back() + length);
+  }
+}
+
 } // namespace tb
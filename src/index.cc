@@ -0,0 +1,141 @@
+#include "tb/index.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <utility>
+
+namespace tb {
+
+namespace {
+
+// Buckets are prefetched this many minimizers ahead of their probe, and
+// locations this many minimizers ahead of being copied into anchors
+constexpr std::size_t kPrefetchDistance = 16uz;
+
+constexpr auto anchor_key = [] [[using gnu: always_inline, pure]] (
+                                Anchor const& anchor) -> std::uint64_t {
+  return (static_cast<std::uint64_t>(anchor.record_id) << 32) |
+         static_cast<std::uint32_t>(anchor.diagonal() + (1ll << 31));
+};
+
+// Stable LSD radix sort on anchor_key, one byte per pass; passes where every
+// key shares the same byte are skipped
+void RadixSort(std::vector<Anchor>& anchors) {
+  constexpr std::size_t kNPasses = sizeof(std::uint64_t);
+  std::array<std::array<std::size_t, 256>, kNPasses> counts{};
+  for (auto const& anchor : anchors) {
+    auto key = anchor_key(anchor);
+    for (std::size_t pass = 0; pass < kNPasses; ++pass) {
+      ++counts[pass][(key >> (pass * 8)) & 0xff];
+    }
+  }
+
+  std::vector<Anchor> buffer(anchors.size());
+  for (std::size_t pass = 0; pass < kNPasses; ++pass) {
+    auto& count = counts[pass];
+    if (std::ranges::any_of(count,
+                            [n = anchors.size()](auto c) { return c == n; })) {
+      continue;
+    }
+
+    std::size_t offset = 0;
+    for (auto& c : count) {
+      offset += std::exchange(c, offset);
+    }
+    for (auto const& anchor : anchors) {
+      buffer[count[(anchor_key(anchor) >> (pass * 8)) & 0xff]++] = anchor;
+    }
+    anchors.swap(buffer);
+  }
+}
+
+}  // namespace
+
+MinimizerIndex::MinimizerIndex(std::span<RecordKMer const> minimizers,
+                               std::size_t max_occurrences) {
+  std::vector<RecordKMer> sorted(minimizers.begin(), minimizers.end());
+  std::ranges::sort(sorted);
+
+  auto n_keys = 0uz;
+  for (std::size_t i = 0; i < sorted.size(); ++i) {
+    n_keys += i == 0 || sorted[i].value() != sorted[i - 1].value();
+  }
+
+  // load factor of at most 1/2
+  auto n_buckets = std::bit_ceil(std::max(2 * n_keys, 2uz));
+  shift_ = 64 - std::countr_zero(n_buckets);
+  buckets_.resize(n_buckets);
+  locations_.reserve(sorted.size());
+
+  for (std::size_t i = 0, j = 0; i < sorted.size(); i = j) {
+    for (j = i + 1; j < sorted.size() && sorted[j].value() == sorted[i].value();
+         ++j);
+    if (j - i > max_occurrences) {
+      continue;
+    }
+
+    auto slot = Slot(sorted[i].value());
+    for (; buckets_[slot].count != 0; slot = (slot + 1) & (n_buckets - 1));
+    buckets_[slot] = Bucket{
+        .value = sorted[i].value(),
+        .begin = static_cast<std::uint32_t>(locations_.size()),
+        .count = static_cast<std::uint32_t>(j - i),
+    };
+    for (auto k = i; k < j; ++k) {
+      locations_.push_back({sorted[k].record_id(), sorted[k].position()});
+    }
+  }
+}
+
+std::vector<Anchor> MinimizerIndex::Query(
+    std::span<KMer const> minimizers) const {
+  auto const mask = buckets_.size() - 1;
+  auto probe = [&](KMer::value_type value) -> Bucket const* {
+    for (auto slot = Slot(value);; slot = (slot + 1) & mask) {
+      if (buckets_[slot].count == 0) {
+        return nullptr;
+      }
+      if (buckets_[slot].value == value) {
+        return &buckets_[slot];
+      }
+    }
+  };
+
+  // three stage pipeline: emit anchors for i, probe bucket of i + D and
+  // prefetch its locations, prefetch bucket of i + 2D
+  std::array<Bucket const*, kPrefetchDistance> hits{};
+  std::vector<Anchor> dst;
+  auto n = static_cast<std::int64_t>(minimizers.size());
+  auto d = static_cast<std::int64_t>(kPrefetchDistance);
+  for (std::int64_t i = -2 * d; i < n; ++i) {
+    if (i >= 0) {
+      if (auto bucket = hits[i % kPrefetchDistance]) {
+        for (auto k = bucket->begin; k < bucket->begin + bucket->count; ++k) {
+          dst.push_back(Anchor{
+              .record_id = locations_[k].record_id,
+              .reference_position = locations_[k].position,
+              .query_position = minimizers[i].position(),
+          });
+        }
+      }
+    }
+
+    if (auto j = i + d; j >= 0 && j < n) {
+      auto bucket = probe(minimizers[j].value());
+      if (bucket) {
+        __builtin_prefetch(&locations_[bucket->begin]);
+      }
+      hits[j % kPrefetchDistance] = bucket;
+    }
+
+    if (i + 2 * d < n) {
+      __builtin_prefetch(&buckets_[Slot(minimizers[i + 2 * d].value())]);
+    }
+  }
+
+  RadixSort(dst);
+  return dst;
+}
+
+}  // namespace tb
@@ -0,0 +1,415 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "tb/algo.hpp"
+
+namespace {
+
+using MinimizeFn = std::vector<tb::KMer> (*)(tb::MinimizeArgs);
+
+constexpr std::int32_t kMaxKMerLength = 31;
+// jump table size of the unrolled samplers
+constexpr std::int32_t kMaxUnrolledWindowLength = 31;
+constexpr std::int32_t kNoLimit = std::numeric_limits<std::int32_t>::max();
+
+// Records are read and minimized in batches of roughly this many bases
+constexpr std::size_t kBatchBases = 64uz << 20uz;
+
+struct Kernel {
+  std::string_view hasher;
+  std::string_view sampler;
+  MinimizeFn fn;
+  std::int32_t max_window_length;
+};
+
+constexpr std::array kKernels = {
+    Kernel{"thomas-wang", "naive", tb::NaiveMinimize, kNoLimit},
+    Kernel{"thomas-wang", "deque", tb::DequeMinimize, kNoLimit},
+    Kernel{"thomas-wang", "argmin", tb::ArgMinMinimize, kNoLimit},
+    Kernel{"thomas-wang", "argmin-unrolled", tb::ArgMinUnrolledMinimize,
+           kMaxUnrolledWindowLength},
+    Kernel{"thomas-wang", "recovery", tb::ArgMinRecoveryMinimize, kNoLimit},
+    Kernel{"thomas-wang", "recovery-unrolled",
+           tb::ArgMinRecoveryUnrolledMinimize, kMaxUnrolledWindowLength},
+    Kernel{"thomas-wang", "split-window", tb::SplitWindowMinimize, kNoLimit},
+    Kernel{"nthash", "argmin-unrolled", tb::NtHashArgMinUnrolledMinimize,
+           kMaxUnrolledWindowLength},
+    Kernel{"nthash", "recovery-unrolled", tb::NtHashRecoveryUnrolledMinimize,
+           kMaxUnrolledWindowLength},
+    Kernel{"nthash", "blocked-recovery", tb::NtHashBlockedRecoveryMinimize,
+           kNoLimit},
+};
+
+enum class Format : std::uint8_t { kTsv, kBinary };
+
+struct Options {
+  std::vector<std::string> inputs;
+  std::string output = "-";
+  Kernel const* kernel = nullptr;
+  std::int32_t window_length = 11;
+  std::int32_t kmer_length = 21;
+  tb::TiePolicy tie_policy = tb::TiePolicy::kLeftmost;
+  std::size_t n_threads = std::max(1u, std::thread::hardware_concurrency());
+  Format format = Format::kTsv;
+};
+
+struct Record {
+  std::string name;
+  tb::MockSequence seq;
+};
+
+constexpr std::string_view kUsage =
+    R"(usage: minimize [options] <fasta/fastq>...
+
+Minimizes every record of the inputs; '-' reads standard input.
+
+options:
+  -k <int>              kmer length in [1, 31] (default 21)
+  -w <int>              window length in kmers (default 11)
+  -t, --threads <int>   worker threads (default: hardware concurrency)
+  --hasher <name>       thomas-wang | nthash (default nthash)
+  --sampler <name>      kernel sampler (default recovery-unrolled)
+  --ties <name>         leftmost | rightmost | robust (default leftmost)
+  --format <name>       tsv | binary (default tsv)
+  -o <path>             output file, '-' for standard output (default -)
+  -h, --help            print this message
+
+samplers per hasher:
+  thomas-wang           naive deque argmin argmin-unrolled recovery
+                        recovery-unrolled split-window
+  nthash                argmin-unrolled recovery-unrolled blocked-recovery
+
+Unrolled samplers support windows of up to 31 kmers. Bases other than ACGT
+or IUPAC codes are read as A.
+
+output:
+  tsv                   record name, position, hash per line
+  binary                16 bytes per minimizer in native byte order: u64 hash,
+                        u32 zero based record index, u32 position with the
+                        strand in the top bit
+Throughput and peak memory are reported on standard error at exit.
+)";
+
+template <class T>
+T ParseInt(std::string_view flag, std::string_view value) {
+  T dst{};
+  auto const end = value.data() + value.size();
+  auto [ptr, ec] = std::from_chars(value.data(), end, dst);
+  if (ec != std::errc() || ptr != end) {
+    throw std::invalid_argument(std::string(flag) +
+                                ": expected an integer, got '" +
+                                std::string(value) + "'");
+  }
+
+  return dst;
+}
+
+Options ParseOptions(int argc, char** argv) {
+  Options options;
+  std::string_view hasher = "nthash";
+  std::string_view sampler = "recovery-unrolled";
+
+  for (int i = 1; i < argc; ++i) {
+    std::string_view arg = argv[i];
+    auto value = [&] -> std::string_view {
+      if (i + 1 == argc) {
+        throw std::invalid_argument(std::string(arg) + ": missing value");
+      }
+      return argv[++i];
+    };
+
+    if (arg == "-h" || arg == "--help") {
+      std::cout << kUsage;
+      std::exit(EXIT_SUCCESS);
+    } else if (arg == "-k") {
+      options.kmer_length = ParseInt<std::int32_t>(arg, value());
+    } else if (arg == "-w") {
+      options.window_length = ParseInt<std::int32_t>(arg, value());
+    } else if (arg == "-t" || arg == "--threads") {
+      options.n_threads = ParseInt<std::size_t>(arg, value());
+    } else if (arg == "--hasher") {
+      hasher = value();
+    } else if (arg == "--sampler") {
+      sampler = value();
+    } else if (arg == "--ties") {
+      auto name = value();
+      if (name == "leftmost") {
+        options.tie_policy = tb::TiePolicy::kLeftmost;
+      } else if (name == "rightmost") {
+        options.tie_policy = tb::TiePolicy::kRightmost;
+      } else if (name == "robust") {
+        options.tie_policy = tb::TiePolicy::kRobust;
+      } else {
+        throw std::invalid_argument("--ties: unknown policy '" +
+                                    std::string(name) + "'");
+      }
+    } else if (arg == "--format") {
+      auto name = value();
+      if (name == "tsv") {
+        options.format = Format::kTsv;
+      } else if (name == "binary") {
+        options.format = Format::kBinary;
+      } else {
+        throw std::invalid_argument("--format: unknown format '" +
+                                    std::string(name) + "'");
+      }
+    } else if (arg == "-o") {
+      options.output = value();
+    } else if (arg.starts_with("-") && arg != "-") {
+      throw std::invalid_argument("unknown option '" + std::string(arg) + "'");
+    } else {
+      options.inputs.emplace_back(arg);
+    }
+  }
+
+  auto kernel = std::ranges::find_if(kKernels, [&](Kernel const& kernel) {
+    return kernel.hasher == hasher && kernel.sampler == sampler;
+  });
+  if (kernel == kKernels.end()) {
+    throw std::invalid_argument("no '" + std::string(sampler) +
+                                "' sampler for the '" + std::string(hasher) +
+                                "' hasher");
+  }
+  options.kernel = &*kernel;
+
+  if (options.inputs.empty()) {
+    throw std::invalid_argument("no input files");
+  }
+  if (options.kmer_length < 1 || options.kmer_length > kMaxKMerLength) {
+    throw std::invalid_argument("-k: must be in [1, 31]");
+  }
+  if (options.window_length < 1 ||
+      options.window_length > options.kernel->max_window_length) {
+    throw std::invalid_argument(
+        "-w: must be in [1, " +
+        std::to_string(options.kernel->max_window_length) + "] for '" +
+        std::string(sampler) + "'");
+  }
+  if (options.n_threads == 0) {
+    throw std::invalid_argument("--threads: must be positive");
+  }
+
+  return options;
+}
+
+// Reads FASTA and four line FASTQ records; FASTA sequences may span lines
+class RecordReader {
+  std::ifstream file_;
+  std::istream* stream_;
+  std::string path_;
+  std::string line_;
+  bool has_line_ = false;
+
+  bool NextLine() {
+    has_line_ = static_cast<bool>(std::getline(*stream_, line_));
+    if (has_line_ && line_.ends_with('\r')) {
+      line_.pop_back();
+    }
+    return has_line_;
+  }
+
+  static void Append(tb::MockSequence& seq, std::string_view bases) {
+    for (auto base : bases) {
+      auto code = tb::kNucleotideCoder[static_cast<std::uint8_t>(base)];
+      seq.push_back(code == 255 ? 0 : code);
+    }
+  }
+
+ public:
+  explicit RecordReader(std::string path) : path_(std::move(path)) {
+    if (path_ == "-") {
+      stream_ = &std::cin;
+    } else {
+      file_.open(path_);
+      if (!file_) {
+        throw std::runtime_error(path_ + ": cannot open");
+      }
+      stream_ = &file_;
+    }
+
+    NextLine();
+  }
+
+  bool Next(Record& dst) {
+    while (has_line_ && line_.empty()) {
+      NextLine();
+    }
+    if (!has_line_) {
+      return false;
+    }
+
+    auto marker = line_.front();
+    if (marker != '>' && marker != '@') {
+      throw std::runtime_error(path_ + ": expected a FASTA or FASTQ header");
+    }
+
+    dst.name = line_.substr(1, line_.find_first_of(" \t") - 1);
+    dst.seq = tb::MockSequence();
+    if (marker == '>') {
+      while (NextLine() && !line_.starts_with('>')) {
+        Append(dst.seq, line_);
+      }
+    } else {
+      if (!NextLine()) {
+        throw std::runtime_error(path_ + ": truncated FASTQ record");
+      }
+      Append(dst.seq, line_);
+      // separator and qualities
+      if (!NextLine() || !NextLine()) {
+        throw std::runtime_error(path_ + ": truncated FASTQ record");
+      }
+      NextLine();
+    }
+
+    if (dst.seq.size() > std::numeric_limits<tb::KMer::position_type>::max()) {
+      throw std::runtime_error(path_ + ": record '" + dst.name +
+                               "' is longer than 2^31 - 1 bases");
+    }
+
+    return true;
+  }
+};
+
+void Write(std::ostream& dst, Format format, std::uint32_t record_id,
+           Record const& record, std::vector<tb::KMer> const& minimizers) {
+  if (format == Format::kBinary) {
+    for (auto const& kmer : minimizers) {
+      tb::RecordKMer record_kmer(kmer.value(), record_id, kmer.position(),
+                                 kmer.strand());
+      dst.write(reinterpret_cast<char const*>(&record_kmer),
+                sizeof(record_kmer));
+    }
+    return;
+  }
+
+  std::string buffer;
+  for (auto const& kmer : minimizers) {
+    buffer += record.name;
+    buffer += '\t';
+    buffer += std::to_string(kmer.position());
+    buffer += '\t';
+    buffer += std::to_string(kmer.value());
+    buffer += '\n';
+  }
+  dst << buffer;
+}
+
+int Run(Options const& options) {
+  using Clock = std::chrono::steady_clock;
+  auto const start = Clock::now();
+
+  std::ofstream file;
+  if (options.output != "-") {
+    file.open(options.output, std::ios::binary);
+    if (!file) {
+      throw std::runtime_error(options.output + ": cannot open");
+    }
+  }
+  std::ostream& output = options.output == "-" ? std::cout : file;
+
+  // shared by the workers, so large buffers are mapped once and reused
+  tb::Arena arena;
+  std::vector<Record> batch;
+  std::vector<std::vector<tb::KMer>> minimizers;
+  std::size_t n_records = 0, n_bases = 0, n_minimizers = 0;
+  Clock::duration kernel_time{};
+
+  auto flush = [&] {
+    minimizers.assign(batch.size(), {});
+    auto const kernel_start = Clock::now();
+    std::atomic<std::size_t> next = 0;
+    {
+      std::vector<std::jthread> workers;
+      for (std::size_t i = 0; i < std::min(options.n_threads, batch.size());
+           ++i) {
+        workers.emplace_back([&] {
+          for (auto j = next++; j < batch.size(); j = next++) {
+            minimizers[j] = options.kernel->fn({
+                .seq = batch[j].seq,
+                .window_length = options.window_length,
+                .kmer_length = options.kmer_length,
+                .tie_policy = options.tie_policy,
+                .arena = &arena,
+            });
+          }
+        });
+      }
+    }
+    kernel_time += Clock::now() - kernel_start;
+
+    for (std::size_t j = 0; j < batch.size(); ++j) {
+      Write(output, options.format, n_records + j, batch[j], minimizers[j]);
+      n_bases += batch[j].seq.size();
+      n_minimizers += minimizers[j].size();
+    }
+    n_records += batch.size();
+    batch.clear();
+  };
+
+  std::size_t batch_bases = 0;
+  for (auto const& path : options.inputs) {
+    RecordReader reader(path);
+    for (Record record; reader.Next(record);) {
+      batch_bases += record.seq.size();
+      batch.push_back(std::move(record));
+      if (batch_bases >= kBatchBases) {
+        flush();
+        batch_bases = 0;
+      }
+    }
+  }
+  flush();
+
+  output.flush();
+  if (!output) {
+    throw std::runtime_error(options.output + ": write failed");
+  }
+
+  auto seconds = [](Clock::duration duration) {
+    return std::chrono::duration<double>(duration).count();
+  };
+  auto const total_seconds = seconds(Clock::now() - start);
+  std::cerr << "kernel\t" << options.kernel->hasher << '/'
+            << options.kernel->sampler << '\n'
+            << "records\t" << n_records << '\n'
+            << "bases\t" << n_bases << '\n'
+            << "minimizers\t" << n_minimizers << '\n'
+            << "minimizers_per_base\t"
+            << static_cast<double>(n_minimizers) / std::max(n_bases, 1uz)
+            << '\n'
+            << "bases_per_second\t" << n_bases / total_seconds << '\n'
+            << "kernel_bases_per_second\t"
+            << n_bases / std::max(seconds(kernel_time), 1e-9) << '\n'
+            << "peak_rss_bytes\t" << tb::PeakRss() << '\n';
+
+  return EXIT_SUCCESS;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::ios::sync_with_stdio(false);
+  try {
+    return Run(ParseOptions(argc, argv));
+  } catch (std::invalid_argument const& e) {
+    std::cerr << "minimize: " << e.what() << "\n\n" << kUsage;
+    return EXIT_FAILURE;
+  } catch (std::exception const& e) {
+    std::cerr << "minimize: " << e.what() << '\n';
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,166 @@
+#include "tb/stats.hpp"
+
+#include <malloc.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <string>
+#include <utility>
+
+namespace tb {
+
+namespace {
+
+// Per thread heap counters maintained by the replaced global operator new;
+// frees from another thread may drive `live_bytes` negative.
+struct HeapCounters {
+  std::size_t n_allocations;
+  std::size_t allocated_bytes;
+  std::int64_t live_bytes;
+  std::int64_t peak_bytes;
+};
+
+thread_local constinit HeapCounters heap_counters{};
+
+}  // namespace
+
+MemoryStatsScope::MemoryStatsScope(MemoryStats* dst) noexcept : dst_(dst) {
+  if (dst_) {
+    n_allocations_ = heap_counters.n_allocations;
+    allocated_bytes_ = heap_counters.allocated_bytes;
+    live_bytes_ = heap_counters.live_bytes;
+    peak_bytes_ = std::exchange(heap_counters.peak_bytes, live_bytes_);
+  }
+}
+
+MemoryStatsScope::~MemoryStatsScope() {
+  if (dst_) {
+    dst_->n_allocations = heap_counters.n_allocations - n_allocations_;
+    dst_->allocated_bytes = heap_counters.allocated_bytes - allocated_bytes_;
+    dst_->peak_bytes = std::max<std::int64_t>(
+        heap_counters.peak_bytes - live_bytes_, 0);
+    heap_counters.peak_bytes =
+        std::max(heap_counters.peak_bytes, peak_bytes_);
+    dst_->peak_rss_bytes = PeakRss();
+  }
+}
+
+std::size_t PeakRss() {
+  std::ifstream status("/proc/self/status");
+  for (std::string line; std::getline(status, line);) {
+    if (line.starts_with("VmHWM:")) {
+      return std::stoull(line.substr(6)) * 1024;
+    }
+  }
+
+  return 0;
+}
+
+void ResetPeakRss() { std::ofstream("/proc/self/clear_refs") << "5"; }
+
+}  // namespace tb
+
+namespace {
+
+// Every replaceable form of global new and delete routes through these, so
+// allocations and frees always pair malloc with free; replacing only some forms
+// mixes this heap with the runtime's (and trips sanitizers).
+void* Allocate(std::size_t n_bytes, std::align_val_t alignment) noexcept {
+  n_bytes = std::max(n_bytes, 1uz);
+  void* ptr = nullptr;
+  if (static_cast<std::size_t>(alignment) <= alignof(std::max_align_t)) {
+    ptr = std::malloc(n_bytes);
+  } else if (posix_memalign(&ptr, static_cast<std::size_t>(alignment),
+                            n_bytes) != 0) {
+    ptr = nullptr;
+  }
+
+  if (ptr) {
+    auto& counters = tb::heap_counters;
+    auto size = malloc_usable_size(ptr);
+    ++counters.n_allocations;
+    counters.allocated_bytes += size;
+    counters.live_bytes += size;
+    counters.peak_bytes = std::max(counters.peak_bytes, counters.live_bytes);
+  }
+  return ptr;
+}
+
+void* AllocateOrThrow(std::size_t n_bytes, std::align_val_t alignment) {
+  auto ptr = Allocate(n_bytes, alignment);
+  if (!ptr) {
+    throw std::bad_alloc();
+  }
+
+  return ptr;
+}
+
+void Release(void* ptr) noexcept {
+  if (ptr) {
+    tb::heap_counters.live_bytes -= malloc_usable_size(ptr);
+    std::free(ptr);
+  }
+}
+
+constexpr auto kDefaultAlignment =
+    std::align_val_t{__STDCPP_DEFAULT_NEW_ALIGNMENT__};
+
+}  // namespace
+
+void* operator new(std::size_t n_bytes) {
+  return AllocateOrThrow(n_bytes, kDefaultAlignment);
+}
+void* operator new[](std::size_t n_bytes) {
+  return AllocateOrThrow(n_bytes, kDefaultAlignment);
+}
+void* operator new(std::size_t n_bytes, std::align_val_t alignment) {
+  return AllocateOrThrow(n_bytes, alignment);
+}
+void* operator new[](std::size_t n_bytes, std::align_val_t alignment) {
+  return AllocateOrThrow(n_bytes, alignment);
+}
+
+void* operator new(std::size_t n_bytes, std::nothrow_t const&) noexcept {
+  return Allocate(n_bytes, kDefaultAlignment);
+}
+void* operator new[](std::size_t n_bytes, std::nothrow_t const&) noexcept {
+  return Allocate(n_bytes, kDefaultAlignment);
+}
+void* operator new(std::size_t n_bytes, std::align_val_t alignment,
+                   std::nothrow_t const&) noexcept {
+  return Allocate(n_bytes, alignment);
+}
+void* operator new[](std::size_t n_bytes, std::align_val_t alignment,
+                     std::nothrow_t const&) noexcept {
+  return Allocate(n_bytes, alignment);
+}
+
+void operator delete(void* ptr) noexcept { Release(ptr); }
+void operator delete[](void* ptr) noexcept { Release(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { Release(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { Release(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { Release(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { Release(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept {
+  Release(ptr);
+}
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept {
+  Release(ptr);
+}
+void operator delete(void* ptr, std::nothrow_t const&) noexcept {
+  Release(ptr);
+}
+void operator delete[](void* ptr, std::nothrow_t const&) noexcept {
+  Release(ptr);
+}
+void operator delete(void* ptr, std::align_val_t,
+                     std::nothrow_t const&) noexcept {
+  Release(ptr);
+}
+void operator delete[](void* ptr, std::align_val_t,
+                       std::nothrow_t const&) noexcept {
+  Release(ptr);
+}
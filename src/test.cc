@@ -1,7 +1,18 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 
+#include <algorithm>
+#include <array>
+#include <map>
+#include <new>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
 #include "gtest/gtest.h"
 #include "tb/algo.hpp"
+#include "tb/index.hpp"
 
 namespace {
 
@@ -21,6 +32,60 @@ class MinimizeTest : public testing::Test {
   tb::MinimizeArgs args_;
 };
 
+// Short kmers hash to few distinct values, so most windows contain ties
+class TieMinimizeTest : public MinimizeTest {
+ protected:
+  TieMinimizeTest() { args_.kmer_length = 3; }
+
+  static constexpr std::array kTiePolicies = {
+      tb::TiePolicy::kLeftmost,
+      tb::TiePolicy::kRightmost,
+      tb::TiePolicy::kRobust,
+  };
+};
+
+// Repeats and low complexity runs make the window minimum move and tie often
+class RepeatMinimizeTest : public testing::Test {
+ protected:
+  RepeatMinimizeTest()
+      : seq_(1uz << 16uz, kSeed, tb::kHumanLikeProfile),
+        args_(tb::MinimizeArgs{
+            .seq = seq_,
+            .window_length = 11,
+            .kmer_length = 21,
+        }) {}
+
+  tb::MockSequence seq_;
+  tb::MinimizeArgs args_;
+};
+
+// Reference sampler over precomputed hashes following TiePolicy semantics
+std::vector<tb::KMer> OracleSample(
+    std::vector<tb::KMer::value_type> const& hashes,
+    std::int32_t window_length, tb::TiePolicy tie_policy) {
+  std::vector<tb::KMer> dst;
+  for (std::int64_t i = 0; i + window_length <= hashes.size(); ++i) {
+    auto min_pos = i;
+    for (auto j = i; j < i + window_length; ++j) {
+      if (tie_policy == tb::TiePolicy::kLeftmost
+              ? hashes[j] < hashes[min_pos]
+              : hashes[j] <= hashes[min_pos]) {
+        min_pos = j;
+      }
+    }
+    if (tie_policy == tb::TiePolicy::kRobust && !dst.empty() &&
+        dst.back().position() >= i &&
+        dst.back().value() == hashes[min_pos]) {
+      min_pos = dst.back().position();
+    }
+    if (dst.empty() || dst.back().position() != min_pos) {
+      dst.emplace_back(hashes[min_pos], min_pos, 0);
+    }
+  }
+
+  return dst;
+}
+
 }  // namespace
 
 TEST_F(MinimizeTest, NaiveDensity) {
@@ -77,3 +142,375 @@ TEST_F(MinimizeTest, NthHashRegression) {
 
   EXPECT_EQ(base_hashes, opt_hashes);
 }
+
+TEST_F(MinimizeTest, NtHashBlockedRecoveryVsNtHashRecovery) {
+  auto recovery_minimizers = tb::NtHashRecoveryUnrolledMinimize(args_);
+  auto blocked_minimizers = tb::NtHashBlockedRecoveryMinimize(args_);
+
+  EXPECT_EQ(recovery_minimizers, blocked_minimizers);
+}
+
+TEST_F(TieMinimizeTest, TiePoliciesAgreeAcrossSamplers) {
+  for (auto tie_policy : kTiePolicies) {
+    args_.tie_policy = tie_policy;
+    auto argmin_minimizers = tb::ArgMinMinimize(args_);
+
+    EXPECT_EQ(argmin_minimizers, tb::ArgMinUnrolledMinimize(args_));
+    EXPECT_EQ(argmin_minimizers, tb::ArgMinRecoveryMinimize(args_));
+    EXPECT_EQ(argmin_minimizers, tb::ArgMinRecoveryUnrolledMinimize(args_));
+    EXPECT_EQ(argmin_minimizers, tb::SplitWindowMinimize(args_));
+  }
+}
+
+TEST_F(TieMinimizeTest, TiePoliciesAgreeAcrossNtHashKernels) {
+  for (auto tie_policy : kTiePolicies) {
+    args_.tie_policy = tie_policy;
+    auto recovery_minimizers = tb::NtHashRecoveryUnrolledMinimize(args_);
+
+    EXPECT_EQ(recovery_minimizers, tb::NtHashArgMinUnrolledMinimize(args_));
+    EXPECT_EQ(recovery_minimizers, tb::NtHashBlockedRecoveryMinimize(args_));
+  }
+}
+
+TEST_F(TieMinimizeTest, RobustNotDenserThanRightmost) {
+  args_.tie_policy = tb::TiePolicy::kRightmost;
+  auto rightmost_minimizers = tb::ArgMinMinimize(args_);
+  args_.tie_policy = tb::TiePolicy::kRobust;
+  auto robust_minimizers = tb::ArgMinMinimize(args_);
+
+  EXPECT_LE(robust_minimizers.size(), rightmost_minimizers.size());
+}
+
+TEST_F(MinimizeTest, MemoryStats) {
+  tb::MemoryStats stats;
+  args_.stats = &stats;
+  auto minimizers = tb::ArgMinMinimize(args_);
+
+  EXPECT_GE(stats.n_allocations, 2);
+  EXPECT_GE(stats.allocated_bytes, stats.peak_bytes);
+  // hashes and the untrimmed output are alive at the same time
+  EXPECT_GE(stats.peak_bytes,
+            (seq_.size() - args_.kmer_length + 1) *
+                (sizeof(tb::KMer::value_type) + sizeof(tb::KMer)));
+  EXPECT_GT(stats.peak_rss_bytes, 0);
+}
+
+TEST(MemoryStatsTest, CountsEveryAllocationForm) {
+  struct alignas(64) Line {
+    std::uint64_t words[8];
+  };
+
+  tb::MemoryStats stats;
+  {
+    tb::MemoryStatsScope scope(&stats);
+    // stable_sort takes its buffer from nothrow new
+    std::vector<int> values(1'000);
+    std::ranges::stable_sort(values);
+    // new-expressions may be elided; calls to the functions may not
+    constexpr auto kAlign = std::align_val_t{alignof(Line)};
+    ::operator delete(::operator new(sizeof(Line), kAlign), kAlign);
+    ::operator delete[](::operator new[](4 * sizeof(Line), kAlign), kAlign);
+    ::operator delete[](::operator new[](4 * sizeof(int), std::nothrow));
+  }
+
+  EXPECT_GE(stats.n_allocations, 5);
+  EXPECT_GE(stats.allocated_bytes, 1'000 * sizeof(int) + 5 * sizeof(Line));
+}
+
+TEST(MinimizeRecordsTest, RecordsVsSingleSequence) {
+  std::vector<tb::MockSequence> records;
+  for (auto n_bases : {1000uz, 7uz, 4099uz, 33uz, 1uz << 12uz}) {
+    records.emplace_back(n_bases, kSeed + records.size());
+  }
+  tb::MockSequenceSet record_set(records);
+
+  auto minimizers = tb::NtHashRecoveryUnrolledMinimizeRecords({
+      .records = record_set,
+      .window_length = 5,
+      .kmer_length = 15,
+  });
+
+  std::vector<tb::RecordKMer> expected;
+  for (std::uint32_t i = 0; i < records.size(); ++i) {
+    if (records[i].size() < 5 + 15 - 1) {
+      continue;
+    }
+    for (auto kmer : tb::NtHashRecoveryUnrolledMinimize({
+             .seq = records[i],
+             .window_length = 5,
+             .kmer_length = 15,
+         })) {
+      expected.emplace_back(kmer.value(), i, kmer.position(), kmer.strand());
+    }
+  }
+
+  EXPECT_EQ(minimizers, expected);
+}
+
+TEST(MockSequenceTest, ProfileDeterministic) {
+  // spans several generation chunks
+  tb::MockSequence lhs(2'500'000uz, kSeed, tb::kHumanLikeProfile);
+  tb::MockSequence rhs(2'500'000uz, kSeed, tb::kHumanLikeProfile);
+
+  ASSERT_EQ(lhs.size(), rhs.size());
+  std::size_t n_mismatches = 0;
+  for (std::size_t i = 0; i < lhs.size(); ++i) {
+    n_mismatches += lhs.Code(i) != rhs.Code(i);
+  }
+  EXPECT_EQ(n_mismatches, 0);
+}
+
+TEST_F(RepeatMinimizeTest, RepeatsAgreeAcrossSamplers) {
+  for (auto tie_policy : {tb::TiePolicy::kLeftmost, tb::TiePolicy::kRobust}) {
+    args_.tie_policy = tie_policy;
+    auto argmin_minimizers = tb::ArgMinMinimize(args_);
+
+    EXPECT_EQ(argmin_minimizers, tb::ArgMinRecoveryUnrolledMinimize(args_));
+    EXPECT_EQ(argmin_minimizers, tb::SplitWindowMinimize(args_));
+    EXPECT_EQ(tb::NtHashArgMinUnrolledMinimize(args_),
+              tb::NtHashBlockedRecoveryMinimize(args_));
+  }
+}
+
+TEST(DifferentialTest, KernelsMatchOracles) {
+  constexpr auto kNCases = 300;
+  constexpr std::array kThomasWangKernels = {
+      std::pair{"DequeMinimize", &tb::DequeMinimize},
+      std::pair{"ArgMinMinimize", &tb::ArgMinMinimize},
+      std::pair{"ArgMinUnrolledMinimize", &tb::ArgMinUnrolledMinimize},
+      std::pair{"ArgMinRecoveryMinimize", &tb::ArgMinRecoveryMinimize},
+      std::pair{"ArgMinRecoveryUnrolledMinimize",
+                &tb::ArgMinRecoveryUnrolledMinimize},
+      std::pair{"SplitWindowMinimize", &tb::SplitWindowMinimize},
+  };
+  constexpr std::array kNtHashKernels = {
+      std::pair{"NtHashArgMinUnrolledMinimize",
+                &tb::NtHashArgMinUnrolledMinimize},
+      std::pair{"NtHashRecoveryUnrolledMinimize",
+                &tb::NtHashRecoveryUnrolledMinimize},
+      std::pair{"NtHashBlockedRecoveryMinimize",
+                &tb::NtHashBlockedRecoveryMinimize},
+  };
+
+  std::mt19937_64 rng_engine(kSeed);
+  auto uniform = [&rng_engine](auto lo, auto hi) {
+    return std::uniform_int_distribution<decltype(hi)>(lo, hi)(rng_engine);
+  };
+  auto rate = [&rng_engine] {
+    return std::uniform_real_distribution(0.0, 0.3)(rng_engine);
+  };
+
+  for (auto i = 0; i < kNCases; ++i) {
+    auto profile = tb::MockSequenceProfile{
+        .gc_content = std::uniform_real_distribution(0.2, 0.8)(rng_engine),
+        .tandem_repeat_rate = rate(),
+        .interspersed_repeat_rate = rate(),
+        .low_complexity_rate = rate(),
+        .n_block_rate = rate() / 10,
+        .n_block_length = 100,
+    };
+    auto n_bases = uniform(1uz, i % 10 == 0 ? 20'000uz : 2'000uz);
+    auto seed = uniform(0, 1 << 20);
+    tb::MockSequence seq(n_bases, seed, profile);
+    tb::MinimizeArgs args{
+        .seq = seq,
+        .window_length = uniform(1, 31),
+        .kmer_length = uniform(1, 31),
+        .tie_policy = static_cast<tb::TiePolicy>(uniform(0, 2)),
+    };
+    SCOPED_TRACE(testing::Message()
+                 << "n_bases=" << n_bases << " seed=" << seed
+                 << " w=" << args.window_length << " k=" << args.kmer_length
+                 << " tie_policy=" << static_cast<int>(args.tie_policy));
+
+    auto naive_minimizers = tb::NaiveMinimize(args);
+    for (auto [name, kernel] : kThomasWangKernels) {
+      EXPECT_EQ(naive_minimizers, kernel(args)) << name;
+    }
+
+    auto hashes = tb::NtHash(args);
+    EXPECT_EQ(hashes, tb::NtHashOpt(args));
+
+    auto oracle_minimizers =
+        OracleSample(hashes, args.window_length, args.tie_policy);
+    for (auto [name, kernel] : kNtHashKernels) {
+      EXPECT_EQ(oracle_minimizers, kernel(args)) << name;
+    }
+  }
+}
+
+TEST(MinimizerIndexTest, ReadSliceAnchorsOnItsDiagonal) {
+  std::vector<std::size_t> record_lengths = {5'000uz, 20'000uz, 3'000uz};
+  tb::MockSequenceSet reference(record_lengths, kSeed);
+  tb::MinimizerIndex index(tb::NtHashRecoveryUnrolledMinimizeRecords({
+      .records = reference,
+      .window_length = 5,
+      .kmer_length = 15,
+  }));
+
+  constexpr std::uint32_t kRecordId = 1;
+  constexpr std::size_t kOffset = 7'777;
+  tb::MockSequence read;
+  for (std::size_t i = 0; i < 2'000; ++i) {
+    read.push_back(
+        reference.sequence().Code(reference.offset(kRecordId) + kOffset + i));
+  }
+  auto read_minimizers = tb::NtHashRecoveryUnrolledMinimize({
+      .seq = read,
+      .window_length = 5,
+      .kmer_length = 15,
+  });
+
+  auto anchors = index.Query(read_minimizers);
+  EXPECT_TRUE(std::ranges::is_sorted(anchors, {}, [](tb::Anchor const& a) {
+    return std::pair(a.record_id, a.diagonal());
+  }));
+  EXPECT_EQ(std::ranges::count_if(anchors,
+                                  [](tb::Anchor const& a) {
+                                    return a.record_id == kRecordId &&
+                                           a.diagonal() == kOffset;
+                                  }),
+            read_minimizers.size());
+}
+
+TEST_F(RepeatMinimizeTest, LevelsMatchSingleLevel) {
+  constexpr std::array<std::int32_t, 3> kWindowLengths = {5, 12, 31};
+  for (auto tie_policy :
+       {tb::TiePolicy::kLeftmost, tb::TiePolicy::kRightmost}) {
+    args_.tie_policy = tie_policy;
+    auto levels = tb::NtHashRecoveryMinimizeLevels({
+        .seq = seq_,
+        .window_lengths = kWindowLengths,
+        .kmer_length = args_.kmer_length,
+        .tie_policy = tie_policy,
+    });
+
+    ASSERT_EQ(levels.size(), kWindowLengths.size());
+    for (std::size_t i = 0; i < levels.size(); ++i) {
+      args_.window_length = kWindowLengths[i];
+      EXPECT_EQ(levels[i], tb::NtHashRecoveryUnrolledMinimize(args_));
+    }
+  }
+}
+
+TEST_F(RepeatMinimizeTest, LevelsNested) {
+  constexpr std::array<std::int32_t, 3> kWindowLengths = {10, 50, 200};
+  auto levels = tb::ArgMinRecoveryMinimizeLevels({
+      .seq = seq_,
+      .window_lengths = kWindowLengths,
+      .kmer_length = args_.kmer_length,
+      .tie_policy = tb::TiePolicy::kRobust,
+  });
+
+  for (std::size_t i = 1; i < levels.size(); ++i) {
+    EXPECT_LT(levels[i].size(), levels[i - 1].size());
+    EXPECT_TRUE(std::ranges::includes(levels[i - 1], levels[i], {},
+                                      &tb::KMer::position,
+                                      &tb::KMer::position));
+  }
+}
+
+TEST(ArenaTest, ReusesBlocksAcrossCalls) {
+  tb::MockSequence seq(1uz << 18uz, kSeed, tb::kHumanLikeProfile);
+  auto args = tb::MinimizeArgs{
+      .seq = seq,
+      .window_length = 11,
+      .kmer_length = 21,
+  };
+  auto expected = tb::NtHashRecoveryUnrolledMinimize(args);
+
+  // explicit huge pages fall back to transparent ones without a reserved pool
+  for (auto huge_pages : {tb::HugePages::kNone, tb::HugePages::kTransparent,
+                          tb::HugePages::kExplicit}) {
+    tb::Arena arena({.huge_pages = huge_pages});
+    args.arena = &arena;
+    EXPECT_EQ(tb::NtHashRecoveryUnrolledMinimize(args), expected);
+    auto mapped_bytes = arena.mapped_bytes();
+    EXPECT_GT(mapped_bytes, 0);
+
+    EXPECT_EQ(tb::NtHashBlockedRecoveryMinimize(args), expected);
+    EXPECT_EQ(tb::NtHashRecoveryUnrolledMinimize(args), expected);
+    EXPECT_EQ(arena.mapped_bytes(), mapped_bytes);
+
+    arena.Release();
+    EXPECT_EQ(arena.mapped_bytes(), 0);
+  }
+}
+
+TEST_F(RepeatMinimizeTest, LevelsRejectBadWindowLengths) {
+  auto levels_args = tb::MinimizeLevelsArgs{
+      .seq = seq_,
+      .window_lengths = {},
+      .kmer_length = args_.kmer_length,
+  };
+  EXPECT_TRUE(tb::NtHashRecoveryMinimizeLevels(levels_args).empty());
+
+  constexpr std::array<std::int32_t, 3> kDescending = {31, 12, 5};
+  levels_args.window_lengths = kDescending;
+  EXPECT_THROW(tb::NtHashRecoveryMinimizeLevels(levels_args),
+               std::invalid_argument);
+  EXPECT_THROW(tb::ArgMinRecoveryMinimizeLevels(levels_args),
+               std::invalid_argument);
+}
+
+TEST_F(RepeatMinimizeTest, KMinMersFollowMinimizers) {
+  constexpr std::int32_t kKMinMerLength = 4;
+  auto check = [&](std::vector<tb::KMer> const& minimizers,
+                   std::vector<tb::KMinMer> const& kminmers) {
+    ASSERT_EQ(kminmers.size(), minimizers.size() - kKMinMerLength + 1);
+
+    // the same run of minimizer hashes always projects to the same value
+    std::map<std::vector<tb::KMer::value_type>, tb::KMinMer::value_type> runs;
+    for (std::size_t i = 0; i < kminmers.size(); ++i) {
+      EXPECT_EQ(kminmers[i].start(), minimizers[i].position());
+      EXPECT_EQ(kminmers[i].end(),
+                minimizers[i + kKMinMerLength - 1].position() +
+                    args_.kmer_length);
+
+      std::vector<tb::KMer::value_type> run;
+      for (std::size_t j = i; j < i + kKMinMerLength; ++j) {
+        run.push_back(minimizers[j].value());
+      }
+      auto [it, _] = runs.emplace(std::move(run), kminmers[i].value());
+      EXPECT_EQ(it->second, kminmers[i].value());
+    }
+
+    std::set<tb::KMinMer::value_type> values;
+    for (auto const& [run, value] : runs) {
+      values.insert(value);
+    }
+    EXPECT_EQ(values.size(), runs.size());
+  };
+
+  for (auto tie_policy : {tb::TiePolicy::kLeftmost, tb::TiePolicy::kRightmost,
+                          tb::TiePolicy::kRobust}) {
+    args_.tie_policy = tie_policy;
+    auto kminmer_args = tb::MinimizeKMinMersArgs{
+        .seq = seq_,
+        .window_length = args_.window_length,
+        .kmer_length = args_.kmer_length,
+        .kminmer_length = kKMinMerLength,
+        .tie_policy = tie_policy,
+    };
+
+    check(tb::ArgMinRecoveryUnrolledMinimize(args_),
+          tb::ArgMinRecoveryUnrolledMinimizeKMinMers(kminmer_args));
+    check(tb::NtHashRecoveryUnrolledMinimize(args_),
+          tb::NtHashRecoveryUnrolledMinimizeKMinMers(kminmer_args));
+  }
+}
+
+TEST_F(RepeatMinimizeTest, KMinMersRejectBadLength) {
+  for (auto kminmer_length : {0, -1}) {
+    auto kminmer_args = tb::MinimizeKMinMersArgs{
+        .seq = seq_,
+        .window_length = args_.window_length,
+        .kmer_length = args_.kmer_length,
+        .kminmer_length = kminmer_length,
+    };
+    EXPECT_THROW(tb::ArgMinRecoveryUnrolledMinimizeKMinMers(kminmer_args),
+                 std::invalid_argument);
+    EXPECT_THROW(tb::NtHashRecoveryUnrolledMinimizeKMinMers(kminmer_args),
+                 std::invalid_argument);
+  }
+}